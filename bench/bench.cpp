@@ -0,0 +1,216 @@
+// benchmark of the public driver calls, runs once after reset (env:bench)
+// or on the host with the simulated hardware (env:bench_native). Every
+// result is printed as a single line of json to Serial:
+//
+//   {"bench":"WriteChar","target":"native","n":1024,"us":13312,
+//    "rate":76923.1,"unit":"chars/s","trn":2048}
+//
+// On the host the time is the simulated time of the SPI transactions and
+// delays (cpu time is not counted), i.e. the results are deterministic and 
+// changes of the bus path show up as differences of "us" and "trn".
+// The "rate" is null if no time passed, e.g. unchanged chars on the host.
+// The host build has its own main(), stdout holds the json lines only.
+// With the DMA bus backend (env:bench_dma) "us" is the cpu time of the
+// calls, the transactions are sent in the background.
+
+#include "hdsp2112.h"
+#include "hdsp2112_udc_font.h"
+#include "hdsp2112_udc_cache.h"
+#ifndef ESP32
+#include "hdsp2112_sim.h"
+#endif
+#ifdef HDSP2112_BENCH_DMA
+#include "hdsp2112_bus_dma.h"
+using Driver = HDSP2112Dma;
+#else
+using Driver = HDSP2112;
+#endif
+
+///< same wiring as the demo sketch (src/main.cpp)
+constexpr int8_t s_cs   = 32;
+constexpr int8_t s_clk  = 18;
+constexpr int8_t s_mosi = 23;
+constexpr int8_t s_miso = 19;
+
+Driver d(s_cs,s_clk,s_mosi,s_miso);
+
+// two texts which differ at every position, so every call changes all chars
+const char *txt[2] = { "ABCDEFGHIJKLMNOPQRSTUVWXYZ012345",
+                       "abcdefghijklmnopqrstuvwxyz6789+-" };
+
+#if defined(HDSP2112_BENCH_DMA)
+const char *target = "esp32-dma";
+#elif defined(ESP32)
+const char *target = "esp32";
+#else
+const char *target = "native";
+#endif
+
+uint32_t t0;     // start of the current benchmark micros()
+uint32_t trn0;   // bus transactions at the start
+
+// starts a benchmark
+inline void start(void) {
+  trn0 = d.GetTransactions();
+  t0 = micros();
+}
+
+// prints the result of a benchmark
+// @param name  name of the benchmark
+// @param n     number of units, e.g. chars
+// @param us    duration [µs]
+// @param trn   number of bus transactions
+// @param unit  unit of the rate, e.g. "chars/s"
+void report(const char *name, uint32_t n, uint32_t us, uint32_t trn, const char *unit) {
+  char rate[24] = "null";             // no time, e.g. nothing written
+  if(us>0) {
+    snprintf(rate,sizeof(rate),"%.1f",(double)n * 1e6 / us);
+  }
+  Serial.printf("{\"bench\":\"%s\",\"target\":\"%s\",\"n\":%lu,\"us\":%lu,"
+                "\"rate\":%s,\"unit\":\"%s\",\"trn\":%lu}\n",
+                name, target, (unsigned long)n, (unsigned long)us,
+                rate, unit, (unsigned long)trn);
+}
+
+// stops a benchmark and prints the result
+// @param name  name of the benchmark
+// @param n     number of units, e.g. chars
+// @param unit  unit of the rate, e.g. "chars/s"
+inline void stop(const char *name, uint32_t n, const char *unit) {
+  report(name,n,micros()-t0,d.GetTransactions()-trn0,unit);
+}
+
+// single chars, each call writes a changed char
+void benchWriteChar(uint8_t nChr, uint16_t loops) {
+  start();
+  for(uint16_t il=0; il<loops; il++) {
+    for(uint8_t pos=0; pos<nChr; pos++) {
+      d.WriteChar(pos,txt[il&1][pos]);
+    }
+  }
+  stop("WriteChar",nChr*loops,"chars/s");
+}
+
+// whole line by WriteText()
+void benchWriteText(uint8_t nChr, uint16_t loops) {
+  start();
+  for(uint16_t il=0; il<loops; il++) {
+    d.WriteText(0,"%.*s",nChr,txt[il&1]);
+  }
+  stop("WriteText",nChr*loops,"chars/s");
+}
+
+// whole line by printf() of the Print class
+void benchPrintf(uint8_t nChr, uint16_t loops) {
+  start();
+  for(uint16_t il=0; il<loops; il++) {
+    d.SetPos(0);
+    d.printf("%.*s",nChr,txt[il&1]);
+  }
+  stop("printf",nChr*loops,"chars/s");
+}
+
+// full refresh of all chars collected in the shadow ram and a single flush
+void benchRefresh(uint8_t nChr, uint16_t loops) {
+  start();
+  for(uint16_t il=0; il<loops; il++) {
+    d.AutoFlush(0);
+    for(uint8_t pos=0; pos<nChr; pos++) {
+      d.WriteChar(pos,txt[il&1][pos]);
+    }
+    d.AutoFlush(1);
+  }
+  stop("refresh",loops,"refresh/s");
+}
+
+// unchanged line, the shadow ram suppresses all writes
+void benchUnchanged(uint8_t nChr, uint16_t loops) {
+  d.WriteText(0,"%.*s",nChr,txt[0]);
+  start();
+  for(uint16_t il=0; il<loops; il++) {
+    d.WriteText(0,"%.*s",nChr,txt[0]);
+  }
+  stop("unchanged",nChr*loops,"chars/s");
+}
+
+// load of a complete user defined font
+void benchSetUdcFont(uint16_t loops) {
+  start();
+  for(uint16_t il=0; il<loops; il++) {
+    d.SetUdcFont((il&1) ? UDC_wipe : UDC_font,UDC_nch);
+  }
+  stop("SetUdcFont",loops,"calls/s");
+  d.SetUdcFont(UDC_font,UDC_nch);
+}
+
+// swap of both fonts glyph by glyph by the udc cache, without reset
+void benchUdcCache(uint16_t loops) {
+  HdspUdcCache<Driver> udc(d,UDC_lib,UDC_nLib);
+  start();
+  for(uint16_t il=0; il<loops; il++) {
+    d.AutoFlush(0);
+    for(uint8_t ic=0; ic<UDC_nch; ic++) {
+      udc.Glyph(((il&1) ? UDC_idWipe : UDC_idFont) + ic);
+    }
+    d.AutoFlush(1);
+  }
+  stop("UdcCache",loops,"fonts/s");
+  d.SetUdcFont(UDC_font,UDC_nch);
+}
+
+// flash bits of all positions changed
+void benchSetFlashBits(uint16_t loops) {
+  start();
+  for(uint16_t il=0; il<loops; il++) {
+    d.SetFlashBits((il&1) ? 0x55555555 : 0xaaaaaaaa);
+  }
+  stop("SetFlashBits",loops,"calls/s");
+  d.SetFlashBits(0);
+}
+
+// clear() of a filled line
+void benchClear(uint8_t nChr, uint16_t loops) {
+  uint32_t us=0;
+  uint32_t trn=0;
+  for(uint16_t il=0; il<loops; il++) {
+    d.WriteText(0,"%.*s",nChr,txt[il&1]);
+    start();
+    d.clear();
+    us  += micros() - t0;              // clear() only
+    trn += d.GetTransactions() - trn0;
+  }
+  report("clear",loops,us,trn,"calls/s");
+}
+
+void setup() {
+  Serial.begin(115200);
+  d.Begin();
+  d.SetUdcFont(UDC_font,UDC_nch);
+  d.Reset();
+  uint8_t nChr = d.GetDisplays() * nPOS;
+  nChr = (nChr<32) ? nChr : 32;        // length of the texts
+  benchWriteChar(nChr,64);
+  benchWriteText(nChr,64);
+  benchPrintf(nChr,64);
+  benchRefresh(nChr,64);
+  benchUnchanged(nChr,64);
+  benchSetUdcFont(4);
+  benchUdcCache(4);
+  benchSetFlashBits(64);
+  benchClear(nChr,16);
+}
+
+void loop() {
+#ifdef ESP32
+  delay(1000);                         // results are printed once
+#endif
+}
+
+#ifndef ESP32
+// entry point on the host, runs the benchmarks once, fails on a violation
+// of the display timing
+int main(void) {
+  setup();
+  return (0==hdspSim.Violations()) ? 0 : 1;
+}
+#endif
@@ -0,0 +1,44 @@
+#ifndef __ARDUINO_SIM_H__
+#define __ARDUINO_SIM_H__
+
+// host replacement of the Arduino core, only the parts used by the driver. 
+// Time is simulated, delay() and delayMicroseconds() advance the clock of 
+// the simulator instead of waiting.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Print.h"
+
+#define INPUT  0x01
+#define OUTPUT 0x03
+#define LOW    0x0
+#define HIGH   0x1
+
+// simulated clock, see hdsp2112_sim.cpp
+void     delay(uint32_t ms);
+void     delayMicroseconds(uint32_t us);
+uint32_t millis(void);
+uint32_t micros(void);
+
+// serial port, writes to stdout
+class HardwareSerial : public Print {
+  public:
+    inline void begin(uint32_t baud) { (void)baud; }
+    virtual size_t write(const uint8_t character) {
+      return (EOF!=putchar(character)) ? 1 : 0;
+    }
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+// gpio, a chip-select driven by the sketch frames a raw SPI transaction
+void     pinMode(uint8_t pin, uint8_t mode);
+void     digitalWrite(uint8_t pin, uint8_t val);
+
+#endif 
+//__ARDUINO_SIM_H__
@@ -0,0 +1,80 @@
+#ifndef __MCP23S17_SIM_H__
+#define __MCP23S17_SIM_H__
+
+// host replacement of the MCP23S17 library (RobTillaart), all register 
+// accesses are forwarded to the simulated hardware, see hdsp2112_sim.h
+
+#include "Arduino.h"
+#include "SPI.h"
+#include "hdsp2112_sim.h"
+
+class MCP23S17 {
+  public:
+    MCP23S17(uint8_t select, uint8_t address=0x00, SPIClass *spi=&SPI) {
+      m_select  = select;
+      m_address = address;
+      (void)spi;
+    }
+
+    // checks the device and sets byte mode, as the library does
+    inline bool begin(bool pullup=true) {
+      (void)pullup;
+      rd(simIOCON);
+      return wr(simIOCON, simSEQOP);
+    }
+
+    inline bool enableHardwareAddress(void) {
+      return wr(simIOCON, rd(simIOCON) | simHAEN);
+    }
+
+    inline bool disableHardwareAddress(void) {
+      return wr(simIOCON, rd(simIOCON) & ~simHAEN);
+    }
+
+    inline bool pinMode8(uint8_t port, uint8_t mask) {
+      return wr((0==port) ? simIODIRA : simIODIRB, mask);
+    }
+
+    inline bool pinMode16(uint16_t mask) {
+      return wr16(simIODIRA, mask);
+    }
+
+    inline bool write8(uint8_t port, uint8_t value) {
+      return wr((0==port) ? simGPIOA : simGPIOB, value);
+    }
+
+    // high byte to port A, low byte to port B
+    inline bool write16(uint16_t value) {
+      return wr16(simGPIOA, value);
+    }
+
+    inline int read8(uint8_t port) {
+      return rd((0==port) ? simGPIOA : simGPIOB);
+    }
+
+    inline uint8_t getAddress(void) { return m_address; }
+
+    inline uint32_t getSPIspeed(void) { return 8000000; }
+
+  private:
+    inline bool wr(uint8_t reg, uint8_t value) {
+      hdspSim.Write((int8_t)m_select, m_address, reg, &value, 1);
+      return true;
+    }
+
+    inline bool wr16(uint8_t reg, uint16_t value) {
+      uint8_t data[2] = { (uint8_t)(value>>8), (uint8_t)(value & 0xff) };
+      hdspSim.Write((int8_t)m_select, m_address, reg, data, 2);
+      return true;
+    }
+
+    inline uint8_t rd(uint8_t reg) {
+      return hdspSim.Read((int8_t)m_select, m_address, reg);
+    }
+
+    uint8_t m_select;
+    uint8_t m_address;
+};
+
+#endif 
+//__MCP23S17_SIM_H__
@@ -0,0 +1,48 @@
+#ifndef __PRINT_SIM_H__
+#define __PRINT_SIM_H__
+
+// host replacement of the Arduino Print class (incl. the ESP32 printf)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+class Print {
+  public:
+    virtual ~Print() {}
+
+    virtual size_t write(const uint8_t character) = 0;
+
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+      for(size_t ic=0; ic<size; ic++) {
+        write(buffer[ic]);
+      }
+      return size;
+    }
+
+    inline size_t print(const char *str) { 
+      return write((const uint8_t*)str, strlen(str)); 
+    }
+
+    inline size_t print(char ch) { 
+      return write((uint8_t)ch); 
+    }
+
+    size_t printf(const char *format, ...) {
+      char buf[256];
+      va_list args;
+      va_start(args, format);
+      int len=vsnprintf(buf,sizeof(buf),format,args);
+      va_end(args);
+      if(len<0) {
+        return 0;
+      }
+      len = (len<(int)sizeof(buf)) ? len : (int)sizeof(buf)-1;
+      return write((const uint8_t*)buf, len);
+    }
+};
+
+#endif 
+//__PRINT_SIM_H__
@@ -0,0 +1,35 @@
+#ifndef __SPI_SIM_H__
+#define __SPI_SIM_H__
+
+// host replacement of the Arduino SPI class, the bus itself is modeled 
+// by the MCP23S17 replacement, see hdsp2112_sim.h. Raw transfers between 
+// digitalWrite(cs,LOW) and digitalWrite(cs,HIGH) are decoded as mcp23s17
+// write transactions.
+
+#include "Arduino.h"
+
+#define MSBFIRST  1
+#define SPI_MODE0 0
+
+class SPISettings {
+  public:
+    SPISettings(uint32_t clock=8000000, uint8_t order=MSBFIRST, uint8_t mode=SPI_MODE0) {
+      (void)clock; (void)order; (void)mode;
+    }
+};
+
+class SPIClass {
+  public:
+    inline void begin(int8_t sck=-1, int8_t miso=-1, int8_t mosi=-1, int8_t ss=-1) {
+      (void)sck; (void)miso; (void)mosi; (void)ss;
+    }
+    inline void end(void) {}
+    inline void beginTransaction(SPISettings settings) { (void)settings; }
+    inline void endTransaction(void) {}
+    uint8_t transfer(uint8_t data);
+};
+
+extern SPIClass SPI;
+
+#endif 
+//__SPI_SIM_H__
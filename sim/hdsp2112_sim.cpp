@@ -0,0 +1,310 @@
+#include "hdsp2112_sim.h"
+#include "Arduino.h"
+#include "SPI.h"
+
+HdspSim  hdspSim;  // the simulated hardware
+SPIClass SPI;      // the simulated SPI bus
+HardwareSerial Serial; // stdout
+
+// ----------------------------------------------------------------------------
+// simulated clock of the Arduino core
+// ----------------------------------------------------------------------------
+
+void delay(uint32_t ms) {
+  hdspSim.Advance((uint64_t)ms * 1000000ull);
+}
+
+void delayMicroseconds(uint32_t us) {
+  hdspSim.Advance((uint64_t)us * 1000ull);
+}
+
+uint32_t millis(void) {
+  return (uint32_t)(hdspSim.Now() / 1000000ull);
+}
+
+uint32_t micros(void) {
+  return (uint32_t)(hdspSim.Now() / 1000ull);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  (void)pin; (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  hdspSim.Select((int8_t)pin, LOW==val);
+}
+
+uint8_t SPIClass::transfer(uint8_t data) {
+  return hdspSim.Transfer(data);
+}
+
+// ----------------------------------------------------------------------------
+// public members of class
+// ----------------------------------------------------------------------------
+
+HdspSim::HdspSim() {
+  m_spi_hz = 8000000;       // default SPI clock of the MCP23S17 library
+  m_overhead_ns = 2000;     // chip-select and transaction setup
+  Begin();
+}
+
+void HdspSim::Begin(void) {
+  m_chain.clear();
+  m_log.clear();
+  m_now = 0;
+  m_violations = 0;
+  m_frame.clear();
+  m_frameCs = -1;
+}
+
+void HdspSim::Select(int8_t cs, bool sel) {
+  if(sel) {
+    m_frame.clear();
+    m_frameCs = cs;
+  } else if(cs == m_frameCs) {
+    m_frameCs = -1;
+    if((m_frame.size()>=3) && (0x40 == (m_frame[0] & 0xf1))) {
+      Write(cs, (m_frame[0]>>1) & 7, m_frame[1], &m_frame[2], (uint8_t)(m_frame.size()-2));
+    }
+  }
+}
+
+uint8_t HdspSim::Transfer(uint8_t data) {
+  if(m_frameCs >= 0) {
+    m_frame.push_back(data);
+  }
+  return 0xff;
+}
+
+void HdspSim::Attach(int8_t cs, uint8_t a1, uint8_t a2) {
+  chain(cs,a1,a2);
+}
+
+SimDisplay &HdspSim::Display(uint8_t hid, int8_t cs, uint8_t a1) {
+  if((cs<0) && !m_chain.empty()) {
+    return m_chain[0].dsp[hid % simDSP];
+  }
+  return chain(cs,a1).dsp[hid % simDSP];
+}
+
+std::string HdspSim::Text(uint8_t nDsp, int8_t cs, uint8_t a1) {
+  std::string txt;
+  for(uint8_t hid=0; hid<nDsp; hid++) {
+    SimDisplay &d = Display(hid,cs,a1);
+    update(d);
+    for(uint8_t pos=0; pos<8; pos++) {
+      uint8_t ch = d.chr[pos];
+      txt += ((ch>=32) && (ch<127)) ? (char)ch : '.';
+    }
+  }
+  return txt;
+}
+
+void HdspSim::Write(int8_t cs, uint8_t dev, uint8_t reg, const uint8_t *data, uint8_t len) {
+  SimTrn t = { m_now, duration(len), cs, dev, reg, len, {0,0,0,0}, false };
+  memcpy(t.data, data, (len<4) ? len : 4);
+  m_log.push_back(t);
+  m_now += t.dur_ns;
+
+  chain(cs);                            // default pair U1=1, U2=7
+  for(SimChain &c : m_chain) {
+    if(c.cs == cs) {
+      write(c, dev, reg, data, len);    // all devices see the transaction
+    }
+  }
+}
+
+void HdspSim::write(SimChain &c, uint8_t dev, uint8_t reg, const uint8_t *data, uint8_t len) {
+  SimMcp *mcp[2] = { &c.u1, &c.u2 };
+  uint8_t adr[2] = { c.a1, c.a2 };
+  for(uint8_t im=0; im<2; im++) {
+    SimMcp &m = *mcp[im];
+    bool hit = (m.reg[simIOCON] & simHAEN) ? (adr[im]==dev) : true;
+    uint8_t r = reg;
+    for(uint8_t ib=0; hit && (ib<len) && (r<sizeof(m.reg)); ib++) {
+      uint8_t old_ctrl = pins(c.u2);
+      if((r==simGPIOA) || (r==simGPIOB)) {
+        r += simOLATA - simGPIOA;         // writing GPIO sets the latch
+      }
+      if((0==im) && ((r==simOLATA) || (r==simOLATB))) {
+        for(uint8_t hid=0; hid<simDSP; hid++) {
+          uint8_t cs_hid = simCS0<<hid;   // address/data within write cycle
+          if(!(old_ctrl & cs_hid) && !(old_ctrl & simWR)) {
+            m_violations++;
+          }
+        }
+      }
+      m.reg[r] = data[ib];
+      if((simIOCON==r) || (simIOCON+1==r)) {
+        m.reg[simIOCON] = m.reg[simIOCON+1] = data[ib];
+      }
+      if((1==im) && (old_ctrl!=pins(c.u2))) {
+        ctrl(c, old_ctrl);                // decode control signals
+      }
+      if((r==simOLATA) || (r==simOLATB)) {
+        r -= simOLATA - simGPIOA;
+      }
+      r = (m.reg[simIOCON] & simSEQOP) ? (r ^ 1) : (r + 1);
+    }
+  }
+}
+
+uint8_t HdspSim::Read(int8_t cs, uint8_t dev, uint8_t reg) {
+  SimChain *pc = &chain(cs);
+  for(SimChain &c : m_chain) {
+    if((c.cs == cs) && ((c.a1 == dev) || (c.a2 == dev))) {
+      pc = &c;                          // device with this address
+    }
+  }
+  SimChain &c = *pc;
+  SimTrn t = { m_now, duration(1), cs, dev, reg, 1, {0,0,0,0}, true };
+  m_now += t.dur_ns;
+
+  uint8_t data = 0xff;
+  SimMcp &m = (c.a2==dev) ? c.u2 : c.u1;
+  if(reg<sizeof(m.reg)) {
+    data = m.reg[reg];
+  }
+  if((c.a1==dev) && (simGPIOB==reg) && (0xff==c.u1.reg[simIODIRB])) {
+    uint8_t ctrl = pins(c.u2);
+    uint8_t nsel = 0;
+    for(uint8_t hid=0; hid<simDSP; hid++) {
+      uint8_t cs_hid = simCS0<<hid;
+      if(!(ctrl & cs_hid) && !(ctrl & simRD)) {
+        data = rdCycle(c, c.dsp[hid], ctrl);
+        nsel++;
+      }
+    }
+    if(nsel>1) {
+      m_violations++;                   // bus conflict
+    }
+  }
+  t.data[0] = data;
+  m_log.push_back(t);
+  return data;
+}
+
+// ----------------------------------------------------------------------------
+// private members of class
+// ----------------------------------------------------------------------------
+
+SimChain &HdspSim::chain(int8_t cs, uint8_t a1, uint8_t a2) {
+  for(SimChain &c : m_chain) {
+    if((c.cs == cs) && (c.a1 == a1)) {
+      return c;
+    }
+  }
+  SimChain c;
+  memset(&c, 0, sizeof(c));
+  c.cs = cs;
+  c.a1 = a1;
+  c.a2 = a2;
+  c.u1.reg[simIODIRA] = c.u1.reg[simIODIRB] = 0xff;  // power-on: inputs
+  c.u2.reg[simIODIRA] = c.u2.reg[simIODIRB] = 0xff;
+  for(SimDisplay &d : c.dsp) {
+    memset(d.chr, ' ', sizeof(d.chr));
+  }
+  m_chain.push_back(c);
+  return m_chain.back();
+}
+
+uint32_t HdspSim::duration(uint8_t len) {
+  uint64_t bits = (2u + len) * 8u;      // opcode + register + data
+  return (uint32_t)(bits * 1000000000ull / m_spi_hz) + m_overhead_ns;
+}
+
+void HdspSim::update(SimDisplay &d) {
+  if(d.test && (m_now >= d.busy_ns)) {  // end of self test
+    d.test  = false;
+    memset(d.chr, ' ', sizeof(d.chr));
+    d.flash = 0;
+    d.cwr   = 0b00100000;               // all zero except result = OK
+    d.uda   = 0x0f;
+  }
+}
+
+void HdspSim::ctrl(SimChain &c, uint8_t old_ctrl) {
+  uint8_t new_ctrl = pins(c.u2);
+  for(uint8_t hid=0; hid<simDSP; hid++) {
+    SimDisplay &d = c.dsp[hid];
+    if(!(new_ctrl & simRES)) {          // reset active
+      memset(d.chr, ' ', sizeof(d.chr));
+      d.flash = 0;
+      d.cwr   = 0;
+      d.test  = false;
+      d.busy_ns = UINT64_MAX;
+    } else if(!(old_ctrl & simRES)) {   // reset released
+      d.busy_ns = m_now + simResetNs;
+    }
+    uint8_t cs_hid = simCS0<<hid;
+    bool wasWr = !(old_ctrl & cs_hid) && !(old_ctrl & simWR);
+    bool isWr  = !(new_ctrl & cs_hid) && !(new_ctrl & simWR);
+    if(wasWr && !isWr && (old_ctrl & simRES)) {
+      wrCycle(c, d, old_ctrl);          // end of write cycle
+    }
+  }
+}
+
+void HdspSim::wrCycle(SimChain &c, SimDisplay &d, uint8_t ctrl) {
+  update(d);
+  if(m_now < d.busy_ns) {
+    m_violations++;                     // display busy
+    return;
+  }
+  uint8_t addr = c.u1.reg[simOLATA] & 0x1f;
+  uint8_t data = c.u1.reg[simOLATB];
+  d.nWr++;
+  if(!(ctrl & simFL)) {                 // flash-RAM
+    uint8_t bit = 1u<<(addr & 7);
+    d.flash = (data & 1) ? (d.flash | bit) : (d.flash & ~bit);
+    return;
+  }
+  switch(addr>>3) {
+    case 0: {                           // UDC address register
+      d.uda = data & 0x0f;
+      break;
+    }
+    case 1: {                           // UDC-RAM
+      if((addr & 7) < 7) {
+        d.udc[d.uda][addr & 7] = data & 0x1f;
+      }
+      break;
+    }
+    case 2: {                           // control-word-register
+      d.cwr = (data & 0b01011111) | (d.cwr & 0b00100000);
+      if(data & 0b10000000) {           // clear char and flash
+        memset(d.chr, ' ', sizeof(d.chr));
+        d.flash = 0;
+        d.busy_ns = m_now + simResetNs;
+      }
+      if(data & 0b01000000) {           // start self test
+        d.test = true;
+        d.busy_ns = m_now + simTestNs;
+      }
+      break;
+    }
+    case 3: {                           // character-RAM
+      d.chr[addr & 7] = data;
+      break;
+    }
+  }
+}
+
+uint8_t HdspSim::rdCycle(SimChain &c, SimDisplay &d, uint8_t ctrl) {
+  update(d);
+  if(m_now < d.busy_ns) {
+    m_violations++;                     // display busy
+    return 0xff;
+  }
+  uint8_t addr = c.u1.reg[simOLATA] & 0x1f;
+  d.nRd++;
+  if(!(ctrl & simFL)) {
+    return (d.flash >> (addr & 7)) & 1;
+  }
+  switch(addr>>3) {
+    case 0:  return d.uda;
+    case 1:  return ((addr & 7) < 7) ? d.udc[d.uda][addr & 7] : 0;
+    case 2:  return d.cwr;
+    default: return d.chr[addr & 7];
+  }
+}
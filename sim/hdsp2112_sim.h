@@ -0,0 +1,187 @@
+#ifndef __HDSP2112_SIM_H__
+#define __HDSP2112_SIM_H__
+
+// host side simulator of the hardware: two mcp23s17 (U1 at address 1,
+// U2 at address 7) with up to four hdsp2112 displays behind each SPI
+// chip-select, further pairs at other HAEN addresses are added by 
+// Attach(). Every SPI transaction is recorded with a timestamp of the
+// simulated clock, the displays decode the bus signals according to the
+// hdsp2112 register map (UDA, UDR, CWR, CHR, flash-RAM).
+
+#include <stdint.h>
+#include <string>
+#include <deque>
+#include <vector>
+
+// mcp23s17 registers (IOCON.BANK=0)
+constexpr uint8_t simIODIRA = 0x00;
+constexpr uint8_t simIODIRB = 0x01;
+constexpr uint8_t simIOCON  = 0x0A;
+constexpr uint8_t simGPIOA  = 0x12;
+constexpr uint8_t simGPIOB  = 0x13;
+constexpr uint8_t simOLATA  = 0x14;
+constexpr uint8_t simOLATB  = 0x15;
+constexpr uint8_t simHAEN   = 0b00001000;    // IOCON hardware address enable
+constexpr uint8_t simSEQOP  = 0b00100000;    // IOCON 1=byte mode
+
+// wiring of the simulated hardware
+constexpr uint8_t simU1     = 1;             // U1: GPA=addr, GPB=data
+constexpr uint8_t simU2     = 7;             // U2: GPB=[res,fl,wr,rd,cs0..cs3]
+constexpr uint8_t simDSP    = 4;             // displays per chip-select
+constexpr uint8_t simRES    = 0b00000001;
+constexpr uint8_t simFL     = 0b00000010;
+constexpr uint8_t simWR     = 0b00000100;
+constexpr uint8_t simRD     = 0b00001000;
+constexpr uint8_t simCS0    = 0b00010000;
+
+// hdsp2112 timing, oscillator 58kHz
+constexpr uint64_t simResetNs = 110000ull;      // reset and clear (3 clocks)
+constexpr uint64_t simTestNs  = 4520000000ull;  // self test 262144/58kHz
+
+// single SPI transaction to a mcp23s17
+struct SimTrn {
+  uint64_t t_ns;      // start time of transaction
+  uint32_t dur_ns;    // duration of transaction
+  int8_t   cs;        // SPI chip-select
+  uint8_t  dev;       // hardware address [0..7]
+  uint8_t  reg;       // first register
+  uint8_t  len;       // number of data bytes
+  uint8_t  data[4];   // data bytes (first 4)
+  bool     rd;        // 0=write 1=read
+};
+
+// internal state of a single mcp23s17
+struct SimMcp {
+  uint8_t reg[0x16];  // register file (BANK=0)
+};
+
+// internal state of a single hdsp2112 display
+struct SimDisplay {
+  uint8_t  chr[8];    // character-RAM
+  uint8_t  flash;     // flash-RAM, bit[n] = position n
+  uint8_t  udc[16][7];// UDC-RAM
+  uint8_t  uda;       // UDC address register
+  uint8_t  cwr;       // control-word-register
+  uint64_t busy_ns;   // no access allowed until (reset, clear, self test)
+  bool     test;      // self test is running
+  uint32_t nWr;       // number of write cycles
+  uint32_t nRd;       // number of read cycles
+};
+
+// a pair of mcp23s17 with its displays
+struct SimChain {
+  int8_t     cs;           // SPI chip-select
+  uint8_t    a1;           // hardware address of U1
+  uint8_t    a2;           // hardware address of U2
+  SimMcp     u1;           // address and data bus
+  SimMcp     u2;           // control signals
+  SimDisplay dsp[simDSP];  // displays
+};
+
+class HdspSim {
+  public:
+    HdspSim();
+
+    // resets the simulated hardware, the clock and the transaction log
+    void Begin(void);
+
+    // sets the timing of a SPI transaction: (2+n) bytes at spi_hz plus
+    // a constant overhead for chip-select and transaction setup
+    // @param spi_hz      SPI clock frequency
+    // @param overhead_ns overhead per transaction
+    inline void SetTiming(uint32_t spi_hz, uint32_t overhead_ns) {
+      m_spi_hz = spi_hz;
+      m_overhead_ns = overhead_ns;
+    }
+
+    // gets the simulated time
+    inline uint64_t Now(void) { return m_now; }
+
+    // advances the simulated time
+    // @param ns nano seconds
+    inline void Advance(uint64_t ns) { m_now += ns; }
+
+    // SPI write transaction to a mcp23s17
+    // @param cs   SPI chip-select
+    // @param dev  hardware address
+    // @param reg  first register
+    // @param data data bytes
+    // @param len  number of data bytes
+    void Write(int8_t cs, uint8_t dev, uint8_t reg, const uint8_t *data, uint8_t len);
+
+    // SPI read transaction from a mcp23s17
+    // @param cs   SPI chip-select
+    // @param dev  hardware address
+    // @param reg  register
+    // @return register value
+    uint8_t Read(int8_t cs, uint8_t dev, uint8_t reg);
+
+    // raw SPI frame, selects or deselects a chip-select. At the end of a 
+    // frame the bytes are decoded as mcp23s17 write transaction.
+    // @param cs  SPI chip-select
+    // @param sel 1=select (start of frame) 0=deselect (end of frame)
+    void Select(int8_t cs, bool sel);
+
+    // raw SPI frame, transfers a byte to the selected chip-select
+    // @param data byte
+    // @return received byte (always 0xff, raw reads are not modeled)
+    uint8_t Transfer(uint8_t data);
+
+    // gets the recorded transactions
+    inline const std::vector<SimTrn> &Log(void) { return m_log; }
+
+    // clears the recorded transactions
+    inline void ClearLog(void) { m_log.clear(); }
+
+    // gets the number of protocol violations, e.g. access of a busy
+    // display, address or data changed during a write cycle
+    inline uint32_t Violations(void) { return m_violations; }
+
+    // adds a pair of mcp23s17 at the given hardware addresses behind a 
+    // chip-select, the pair U1=1, U2=7 is added on first access
+    // @param cs    SPI chip-select
+    // @param a1    hardware address of U1
+    // @param a2    hardware address of U2
+    void Attach(int8_t cs, uint8_t a1, uint8_t a2);
+
+    // gets a display
+    // @param hid   display identifier [0..3] behind chip-select cs
+    // @param cs    SPI chip-select (-1=first chain)
+    // @param a1    hardware address of U1
+    SimDisplay &Display(uint8_t hid, int8_t cs=-1, uint8_t a1=simU1);
+
+    // gets the visible text of all displays behind chip-select cs, chars
+    // outside [32..126] are shown as '.'
+    // @param nDsp  number of displays
+    // @param cs    SPI chip-select (-1=first chain)
+    // @param a1    hardware address of U1
+    std::string Text(uint8_t nDsp=simDSP, int8_t cs=-1, uint8_t a1=simU1);
+
+  private:
+    SimChain &chain(int8_t cs, uint8_t a1=simU1, uint8_t a2=simU2);
+    void write(SimChain &c, uint8_t dev, uint8_t reg, const uint8_t *data, uint8_t len);
+    void update(SimDisplay &d);
+    void ctrl(SimChain &c, uint8_t old_ctrl);
+    void wrCycle(SimChain &c, SimDisplay &d, uint8_t ctrl);
+    uint8_t rdCycle(SimChain &c, SimDisplay &d, uint8_t ctrl);
+    uint32_t duration(uint8_t len);
+
+    // control signals at U2.PORT_B, inputs are pulled up by the displays
+    inline uint8_t pins(SimMcp &u2) {
+      return u2.reg[simOLATB] | u2.reg[simIODIRB];
+    }
+
+    std::deque<SimChain>  m_chain;
+    std::vector<uint8_t>  m_frame;      // bytes of the raw SPI frame
+    int8_t m_frameCs;                   // chip-select of the raw frame
+    std::vector<SimTrn>   m_log;
+    uint64_t m_now;
+    uint32_t m_spi_hz;
+    uint32_t m_overhead_ns;
+    uint32_t m_violations;
+};
+
+extern HdspSim hdspSim;
+
+#endif
+//__HDSP2112_SIM_H__
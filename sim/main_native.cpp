@@ -0,0 +1,23 @@
+// entry point of the native (host) build, runs the Arduino sketch from 
+// src/main.cpp once on the simulated hardware and prints a summary of 
+// the SPI transactions. Not part of the unit tests (pio test -e native),
+// they have their own main().
+
+#include "Arduino.h"
+#include "hdsp2112_sim.h"
+
+#ifndef PIO_UNIT_TESTING
+void setup(void);
+void loop(void);
+
+int main(void) {
+  setup();
+  loop();
+  const std::vector<SimTrn> &log = hdspSim.Log();
+  printf("display    : [%s]\n", hdspSim.Text(2).c_str());
+  printf("sim. time  : %.3f s\n", hdspSim.Now() / 1e9);
+  printf("SPI trans. : %u\n", (unsigned)log.size());
+  printf("violations : %u\n", (unsigned)hdspSim.Violations());
+  return (0==hdspSim.Violations()) ? 0 : 1;
+}
+#endif
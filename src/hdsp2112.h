@@ -1,25 +1,46 @@
 #ifndef __HDSP2112_H__
 #define __HDSP2112_H__ 
 
-#include "MCP23S17.h"
+#include "hdsp2112_bus.h"
+#include "hdsp2112_queue.h"
+#include "hdsp2112_utf8.h"
+#include "hdsp2112_fmt.h"
 
-///< configure number of displays in use 
+#ifdef ESP32
+#include <esp_timer.h>
+#endif
+
+///< configure number of displays in use (default of the constructors)
 constexpr uint8_t nDSP     = 2;              // number of displays 
 constexpr uint8_t nPOS     = 8;              // number of chars per display
 constexpr uint8_t maxPOS   = nPOS * nDSP;    // total number of chars
 
-///< use the standard ESP32 SPI ports (SPI_CLK=18, SPI_MOSI=23, SPI_MISO=19)
-constexpr int8_t SPI_clk   = 18;             // SPI clock 
-constexpr int8_t SPI_mosi  = 23;             // SPI master-out-slave-in
-constexpr int8_t SPI_miso  = 19;             // SPI master-in-slave-out
+///< a chain (two mcp23s17) drives up to 4 displays (CS0..CS3), several 
+///< chains on separate SPI chip-selects or HAEN addresses form a single line
+constexpr uint8_t nCHNDSP  = 4;              // displays per chain
+constexpr uint8_t maxCHN   = 4;              // max. number of chains
+constexpr uint8_t maxDSP   = nCHNDSP*maxCHN; // max. number of displays
+constexpr uint8_t maxCHR   = nPOS * maxDSP;  // max. total number of chars
+static_assert(fmtTMP > maxCHR, "the scratch of hdspFormat() holds a whole line");
+constexpr uint16_t dspALL  = 0xffff;         // mask of all displays
+
+///< number of commands in the queue of the render task (power of 2)
+constexpr uint16_t nQUEUE  = 64;
 
-///< two mcp23s17 are connected in parallel using HAEN and addresses 1 and 7
-constexpr uint8_t U1_addr  = 0b00000001;     // 0b001=0x1 --> register=0x21 
-constexpr uint8_t U2_addr  = 0b00000111;     // 0b111=0x7 --> register=0x27
-constexpr uint8_t PORT_A   = 0;              // Port-A = Pin[21..28]
-constexpr uint8_t PORT_B   = 1;              // Port-B = Pin[ 1.. 8]
+///< duration of the hdsp2112 self test: 262144 clocks, typ. 4.6s (57kHz) 
+///< max. 9.2s (28kHz)
+constexpr uint32_t msSELFTEST    = 4600;
+constexpr uint32_t msSELFTESTMAX = 9200;
 
-// m_ctrl = U2.PORT_B[0..7] used as hdsp2112 control signals
+///< clear of char-RAM and flash-RAM by cwrCLEAR, 3 clocks (min. 110µs)
+constexpr uint32_t usCLEAR = 110;
+
+// called when the self test of all displays is finished
+// @param ok     result, bit[n]=1 self test of display n passed
+// @param tested bit[n]=1 display n was tested
+typedef void (*HdspTestCb)(uint16_t ok, uint16_t tested);
+
+// m_ctrl[] = U2.PORT_B[0..7] of each chain used as hdsp2112 control signals
 constexpr uint8_t gpbRES   = 0b00000001;     // U2.GPB[0] = reset
 constexpr uint8_t gpbFL    = 0b00000010;     // U2.GPB[1] = flash-bit
 constexpr uint8_t gpbWR    = 0b00000100;     // U2.GPB[2] = write enable
@@ -29,12 +50,25 @@ constexpr uint8_t gpbCS1   = 0b00100000;     // U2.GPB[5] = cs display 1
 constexpr uint8_t gpbCS2   = 0b01000000;     // U2.GPB[6] = cs display 2
 constexpr uint8_t gpbCS3   = 0b10000000;     // U2.GPB[7] = cs display 3
 
+// mask of all cs signals
+constexpr uint8_t gpbCS    = gpbCS0|gpbCS1|gpbCS2|gpbCS3;
+
+// number of bus transactions of a single WrData() cycle, Mcp23s17Bus: 
+// U1.PORT_A+PORT_B (addr+data), U2.PORT_B (cs+wr low, then cs+wr high)
+constexpr uint8_t trnWrData = 2;
+
 // internal hdsp2112 control-word-register flags
 constexpr uint8_t cwrCLEAR = 0b10000000;     // 0=normal 1=clear flash and char
 constexpr uint8_t cwrTEST  = 0b01000000;     // 0=normal 1=self test
 constexpr uint8_t cwrTSTOK = 0b00100000;     // selftest result 0=failed 1=OK
 constexpr uint8_t cwrBLINK = 0b00010000;     // 0=off 1=blinking
 constexpr uint8_t cwrFLASH = 0b00001000;     // 0=off 1=flashing
+constexpr uint8_t cwrBRIGHT= 0b00000111;     // brightness 0=100% 7=0%
+
+// perceived lightness L* [0.1%] of the brightness levels 0..7, i.e. of 
+// 100%, 80%, 53%, 40%, 27%, 20%, 13% and 0% luminous intensity, the 
+// brightness fades are linear in L*
+constexpr int16_t fdL[8] = { 1000, 917, 779, 695, 590, 518, 428, 0 };
 
 // internal hdsp2112 base addresses
 constexpr uint8_t adrUDA   = 0b00000000;     // User-Defined-Address
@@ -42,55 +76,163 @@ constexpr uint8_t adrUDR   = 0b00001000;     // User-Defined-RAM
 constexpr uint8_t adrCWR   = 0b00010000;     // Control-Word-Register
 constexpr uint8_t adrCHR   = 0b00011000;     // character-RAM
 
-// ranges for ascii and extended user defined chars 
-constexpr uint8_t utf8Ascii= 128;            // ascii chars 
-constexpr uint8_t utf8chUDC= utf8Ascii+16;   // user defined chars
+// ranges for ascii and extended user defined chars, see hdsp2112_utf8.h
 
-// main class is derived from Print 
-class HDSP2112 : public Print {
-  private:
-    MCP23S17 *m_U1;     // PORT_A[0..7]=data[0..7] PORT_B[0..4]=addr[0..4]
-    MCP23S17 *m_U2;     // PORT_B[0..4]=[res,fl,wr,rd,cs0,cs1]
-    bool m_ok;          // 1=(U1 and U2 are valid)  0=(alloc failed)
+// user defined char ram, 16 chars with 5 columns x 7 rows
+constexpr uint8_t UDC_nch  = 16;             // number of user defined chars
+constexpr uint8_t UDC_rows = 7;              // rows per character
+
+// shadow of the internal ram of a single hdsp2112 display, the dirty 
+// bits mark the locations which are not yet written to the display
+struct HdspShadow {
+  uint8_t  chr[nPOS];                 // character-RAM
+  uint8_t  udc[UDC_nch][UDC_rows];    // UDC-RAM
+  uint8_t  flash;                     // flash-RAM, bit[n] = position n
+  uint8_t  cwr;                       // control-word-register
+  uint8_t  dChr;                      // dirty chars, bit[n] = position n
+  uint8_t  dFlash;                    // dirty flash bits, bit[n] = position n
+  uint16_t dUdc;                      // dirty udc chars, bit[n] = udc char n
+  uint16_t vUdc;                      // valid udc chars, bit[n] = udc char n
+  uint8_t  dRow[UDC_nch];             // dirty rows of udc char n, bit[r] = row r
+  bool     dCwr;                      // dirty control-word-register
+};
 
-    int8_t m_spi_cs;    // SPI chip-select
-    int8_t m_spi_clk;   // SPI clock
-    int8_t m_spi_mosi;  // SPI master-out-clock-in
-    int8_t m_spi_miso;  // SPI master-in-clock-out
+// single write cycle, written interleaved with the cycles of other chains
+struct HdspWr {
+  uint8_t  hid;                       // hdsp2112 identifier [0..maxDSP-1]
+  uint8_t  addr;                      // address
+  uint8_t  data;                      // data
+  bool     hold;                      // 1=cs stays low after the cycle,
+                                      //   the next cycle is to the same hid
+};
+
+// brightness fade of a single display
+struct HdspFade {
+  uint32_t t0;                        // start micros()
+  uint32_t dur;                       // duration [µs]
+  uint8_t  from;                      // brightness at the start [0..7]
+  uint8_t  to;                        // brightness at the end [0..7]
+};
 
-    uint8_t m_ctrl;     // control-byte [RES,FL,WR,RD,CS0,CS1,CS2,CS3]
+// main class is derived from Print, the bus backend is a template 
+// parameter (see hdsp2112_bus.h), HDSP2112 uses the two mcp23s17
+template<class Bus>
+class HDSP2112T : public Print {
+  private:
+    Bus *m_bus[maxCHN]; // bus backend of each chain, address, data and 
+                        // control signals of up to 4 displays
+    uint8_t m_nChn;     // number of chains
+    uint8_t m_nDsp;     // number of displays, display hid is connected to 
+                        // chain hid/4 at CS[hid%4]
+    uint8_t m_maxPos;   // total number of chars nPOS*m_nDsp
+    bool m_own;         // 1=m_bus[0] allocated by constructor 
+    bool m_ok;          // 1=(bus is valid)  0=(alloc failed)
+
+    uint8_t m_ctrl[maxCHN]; // control-byte of each chain 
+                        // [RES,FL,WR,RD,CS0,CS1,CS2,CS3]
     uint8_t m_cwr;      // internal hdsp2112 control-word-register:
                         // [CLR, selftest, blink, flash, bright(3)]
     
     uint8_t m_pos;      // current cursor position 
+    HdspUtf8 m_utf8;    // utf8 decoder state of print(), write()
+
+    HdspShadow m_shd[maxDSP]; // shadow ram of all displays
+    uint8_t m_chr[maxCHR]; // chars as written by the caller, in async mode
+                        // the shadow ram belongs to the render task
+    uint8_t m_txtLo;    // first char changed by the caller, not yet posted
+    uint8_t m_txtHi;    // end of the changed chars (m_txtHi<=m_txtLo: none)
+    bool m_autoFlush;   // 1=flush after each call  0=flush on demand
+
+    HdspQueue<HdspCmd,nQUEUE> m_queue; // commands to the render task
+    bool m_async;       // 1=post all calls to the render task
+    const void *m_service; // task/thread within Service()
+    uint32_t m_nOverflow;  // number of commands lost, queue was full
+    uint32_t m_tPost;   // time stamp of oldest command not yet flushed
+    bool m_pending;     // 1=commands not yet flushed
+    uint32_t m_maxLatency; // max. time from post to flush [µs]
+
+    uint16_t m_busy;    // bit[n]=1 display n in self test, no access
+    volatile bool m_testRun; // 1=self test started and not finished
+    uint16_t m_testMask;// displays under test
+    volatile uint16_t m_testOK; // bit[n]=1 self test of display n passed
+    uint32_t m_testStart; // start of self test millis()
+    uint32_t m_testDur; // duration of self test [ms]
+    HdspTestCb m_testCb;// called when self test is finished
+
+    HdspFade m_fade[maxDSP]; // brightness fades
+    uint16_t m_fadeMask;// bit[n]=1 display n is fading
+    uint8_t m_fadeCnt;  // number of the last Fade() started by Service()
+    volatile uint8_t m_fadeReq; // number of the last Fade() call (mod 256)
+    volatile uint8_t m_fadeAck; // number of the last Fade() finished
+
+    uint16_t m_scrubPeriod; // time between two scrub runs [ms], 0=off
+    uint32_t m_scrubLast; // start of the last scrub run millis()
+    uint8_t m_scrubHid; // display of the next scrub run
+    uint32_t m_scrubRuns; // number of scrub runs
+    uint32_t m_scrubFixed;// number of cells rewritten by the scrub
+#ifdef ESP32
+    esp_timer_handle_t m_fadeTimer; // wakes the render task for fades
+    TaskHandle_t m_task;// render task
+    uint32_t m_period;  // max. period of the render task [ms]
+
+    // render task, waits for a notification or the period and calls 
+    // Service()
+    // @param arg instance of driver
+    static void renderTask(void *arg);
+
+    // esp_timer callback, wakes the render task at the next level change 
+    // of a fade
+    // @param arg instance of driver
+    static void fadeTimer(void *arg);
+#endif
 
 
   public:
-    // constructor
+    // constructor, allocates a SPI based bus backend
     // @param spi_cs    chip select 
     // @param spi_clk   spi-clock           (default=VSPI)
     // @param spi_mosi  master-out-slave-in (default=VSPI)
     // @param spi_miso  master-in-slave-out (default=VSPI)
-    HDSP2112(const int8_t spi_cs, 
-             const int8_t spi_clk  = SPI_clk, 
-             const int8_t spi_mosi = SPI_mosi, 
-             const int8_t spi_miso = SPI_miso
-             ); 
+    // @param nDsp      number of displays [1..4]
+    HDSP2112T(const int8_t spi_cs, 
+              const int8_t spi_clk  = SPI_clk, 
+              const int8_t spi_mosi = SPI_mosi, 
+              const int8_t spi_miso = SPI_miso,
+              const uint8_t nDsp    = nDSP
+              ); 
+
+    // constructor with a given bus backend, the caller keeps the ownership
+    // @param bus  bus backend
+    // @param nDsp number of displays [1..4]
+    explicit HDSP2112T(Bus *bus, uint8_t nDsp=nDSP);
+
+    // constructor with several chains, each with its own bus backend, e.g. 
+    // mcp23s17 pairs on separate SPI chip-selects or HAEN addresses. The 
+    // displays form a single line, display hid is connected to chain hid/4 
+    // at CS[hid%4]. The caller keeps the ownership of the backends.
+    // @param bus  bus backends, one per chain
+    // @param nChn number of chains [1..maxCHN]
+    // @param nDsp number of displays [1..4*nChn]
+    HDSP2112T(Bus *const *bus, uint8_t nChn, uint8_t nDsp);
 
     // destructor
-    // frees the two dynamic allocated MCP23S17 instances m_U1 and m_U2
-    inline ~HDSP2112() {
-      if(NULL!=m_U1) {
-        delete m_U1;
-        m_U1=NULL; 
+    // frees the bus backend, if allocated by the constructor
+    inline ~HDSP2112T() {
+      if(m_own && (NULL!=m_bus[0])) {
+        delete m_bus[0];
       }
-      if(NULL!=m_U2) {
-        delete m_U2; 
-        m_U2=NULL; 
-      } 
+      m_bus[0]=NULL;
       m_ok=false;
     }
 
+    // gets the number of displays
+    // @return number of displays
+    inline uint8_t GetDisplays(void) { return m_nDsp; }
+
+    // gets the number of chains
+    // @return number of chains
+    inline uint8_t GetChains(void) { return m_nChn; }
+
     // resets all hdsp2112 displays 
     // - set CS=low and RES=low 
     // - wait pulse width 10µs (min. 300ns) 
@@ -98,9 +240,8 @@ class HDSP2112 : public Print {
     // - and wait until device is ready 1ms (min. 110µs)
     void Reset(void);
 
-    // inits the two mcp23s17 and all hdsp2112 displays
-    // - start SPI Bus
-    // - init the two mcp23s17 port expander
+    // inits the bus backend and all hdsp2112 displays
+    // - init the bus backend, e.g. SPI and the two mcp23s17 port expander
     // - reset all hdsp2112 displays
     void Begin(void);
 
@@ -117,27 +258,100 @@ class HDSP2112 : public Print {
     // @param ch   character to be printed
     void WriteChar(const uint8_t pos, char ch);
 
-    // sets the cursor position to pos and prints text printf() like 
+    // sets the cursor position to pos and prints text printf() like, the
+    // text is formatted directly into the shadow ram (see hdsp2112_fmt.h)
     // @param pos    cursor position
     // @param format printf style format string
     // @param ...    variable parameters
+    // @return number of chars written
     size_t WriteText(const uint8_t pos, const char *format, ...);
 
-    // starts selftest with cwrTEST=1, waits 6 sec, stops selftest with 
-    // cwrTEST=0, reads back control-word-register, and checks 
-    // cwrTSTOK[0=failed, 1=OK]
-    // @param hid hdsp2112 identifier [0..3]
+    // prints text printf() like into a window of the line, aligned within
+    // the window and padded with blanks. A text longer than the window is
+    // cut at the end of the window. The cursor is set behind the text.
+    // @param pos    first position of the window
+    // @param width  number of chars of the window (0=up to the end)
+    // @param align  alLEFT, alRIGHT or alCENTER
+    // @param format printf style format string
+    // @param ...    variable parameters
+    // @return number of chars of the text within the window
+    size_t WriteField(uint8_t pos, uint8_t width, uint8_t align, const char *format, ...);
+
+    // WriteField() with a va_list, e.g. for the windows of hdsp2112_window.h
+    // @param pos    first position of the window
+    // @param width  number of chars of the window (0=up to the end)
+    // @param align  alLEFT, alRIGHT or alCENTER
+    // @param format printf style format string
+    // @param args   variable parameters
+    // @return number of chars of the text within the window
+    size_t WriteFieldV(uint8_t pos, uint8_t width, uint8_t align, const char *format, va_list args);
+
+    // runs the selftest of a single display and waits until it is finished, 
+    // see StartSelftest(). Without render task (also in async mode) the 
+    // test is advanced by calling Service() while waiting.
+    // @param hid hdsp2112 identifier [0..nDsp-1]
     // @return test result [0=failed, 1=OK]
     uint8_t Selftest(uint8_t hid);
 
-    // clears all displays, i.e. fills all chars with blanks, finally 
-    // sets cursor position to 0
+    // starts the selftest of the given displays at once with cwrTEST=1 and 
+    // returns immediately. Service() waits until the test is finished, 
+    // reads back the control-word-registers and checks cwrTSTOK[0=failed, 
+    // 1=OK]. Afterwards the control-word, chars and flash bits are 
+    // restored. The displays under test are not accessed, changes are 
+    // written after the test.
+    // @param mask     displays to test, bit[n]=1 display n
+    // @param cb       called when the test is finished (NULL=none)
+    // @param duration duration of the self test [ms]
+    // @return 1=started 0=a self test is already running
+    bool StartSelftest(uint16_t mask, HdspTestCb cb=NULL, uint32_t duration=msSELFTEST);
+
+    // checks if a self test started by StartSelftest() is running
+    // @return 1=running 0=finished
+    inline bool SelftestBusy(void) { return m_testRun; }
+
+    // gets the result of the last self test 
+    // @return bit[n]=1 self test of display n passed
+    inline uint16_t GetSelftestResult(void) { return m_testOK; }
+
+    // turns on the background scrub, which detects chars and control-words
+    // corrupted by noise on the bus. Every period_ms Service() reads back the
+    // char-RAM and the control-word of the next display within a single read
+    // run, compares them with the shadow ram and rewrites the cells which
+    // differ. A run is skipped while changes are not yet flushed or a self
+    // test is running, so normal updates are not delayed.
+    // @param period_ms time between two runs [ms], 0=off
+    inline void SetScrub(uint16_t period_ms) { m_scrubPeriod = period_ms; }
+
+    // @return number of scrub runs, one display per run
+    inline uint32_t GetScrubRuns(void) { return m_scrubRuns; }
+
+    // @return number of cells rewritten by the scrub
+    inline uint32_t GetScrubFixed(void) { return m_scrubFixed; }
+
+    // clears all displays, i.e. fills all chars with blanks and clears the
+    // flash bits, finally sets cursor position to 0. The displays are 
+    // cleared by the hardware, a single write of cwrCLEAR to all displays.
+    // With AutoFlush(0) only the shadow ram is filled with blanks and its
+    // flash bits are cleared, the next Flush() writes them.
     inline void clear(void){ 
-      SetPos(0);
-      for(uint8_t pos=0;pos<maxPOS;pos++){
-        WriteChar(' ');
+      HDSP_PROF(prfClear);
+      if(m_ok && m_autoFlush) {
+        memset(m_chr,' ',m_maxPos); // chars of the caller, see GetChar()
+        if(posting()) {
+          post(cmdCLEAR,0,0);        // render task clears the displays
+          kick();
+        } else {
+          clearDisplays();
+        }
+      } else {
+        SetPos(0);
+        for(uint8_t pos=0;pos<m_maxPos;pos++){
+          WriteChar(' ');
+        }
+        for(uint8_t pos=0;pos<m_maxPos;pos+=32){
+          SetFlashBits(0,pos,(m_maxPos-pos<32) ? m_maxPos-pos : 32);
+        }
       }
-      delay(20);
       SetPos(0);
     }
 
@@ -150,43 +364,176 @@ class HDSP2112 : public Print {
           uint8_t ms=(1u<<mc);       // mask bit
           m_cwr = (ms==(bn&ms))? m_cwr|ms : m_cwr& ~ms; 
         }
-        for(uint8_t hid=0;hid<nDSP; hid++) { 
-          WrData(adrCWR,m_cwr,hid);  // set brightness for all displays
-        }
+        SetCwr(cwrBRIGHT,m_cwr,dspALL); // set brightness for all displays
+      }
+    }
+
+    // sets brightness of a group of displays, e.g. a zone of the line. 
+    // The other displays keep their brightness.
+    // @param brightness [0..7] 0=100% 7=0%
+    // @param dsp        displays, bit[n] = display hid n
+    inline void SetBrightness(uint8_t brightness, uint16_t dsp) { 
+      if(m_ok) {
+        SetCwr(cwrBRIGHT,brightness,dsp);
       }
     }
     
+    // fades the brightness of a group of displays to a level within a given
+    // time. The 8 levels are passed on a perceptual curve (linear in L*, see
+    // fdL), the level changes of several displays are written at once. The 
+    // call does not block: the fade is advanced by Service(), i.e. by the 
+    // render task, which is woken by an esp_timer at every level change, or
+    // by the user calling Service() periodically.
+    // @param level [0..7] 0=100% 7=0%
+    // @param ms    duration [ms], 0=at once
+    // @param dsp   displays, bit[n] = display hid n
+    void Fade(uint8_t level, uint16_t ms, uint16_t dsp=dspALL);
+
+    // checks if a fade is running
+    // @return 1=fading 0=all fades finished
+    inline bool Fading(void) { return m_fadeReq != m_fadeAck; }
+
     // sets flash bits according the given flash_bits, each bit belongs to a 
     // single char within a corresponding display. The arrangement of the 
     // flash bits: MSB=leftmost character in leftmost display MSB=rightmost 
-    // character in rightmost display. 
+    // character in rightmost display. Only the first 32 characters are 
+    // covered. Only the changed bits are written to the displays.
     // @param flash bits [0=permanently on, 1=flash]
-    void SetFlashBits(uint32_t flash_bits);
+    inline void SetFlashBits(uint32_t flash_bits) {
+      SetFlashBits(flash_bits,0,32);
+    }
+
+    // sets the flash bits of all chars of more than 4 displays, fb[0] bit7 
+    // is the leftmost char, fb[0] bit0 the 8th char, fb[1] bit7 the 9th ...
+    // @param fb flash bits, one byte per display [0=permanently on, 1=flash]
+    // @param n  number of bytes
+    void SetFlashBits(const uint8_t *fb, uint8_t n);
+
+    // sets the flash bits of up to 32 chars from a position on, MSB=char 
+    // at position pos. The other chars keep their flash bits.
+    // @param fb  flash bits [0=permanently on, 1=flash]
+    // @param pos first position
+    // @param n   number of chars [1..32]
+    void SetFlashBits(uint32_t fb, uint8_t pos, uint8_t n);
 
 
     // turns on/off flash mode for all displays. A previous call of 
     // SetFlashBits() determines which positions within the display will 
     // flash.
-    // @param mode [0=on, 1=off]
+    // @param mode [0=off, 1=on]
     inline void FlashMode(uint8_t mode) {
       if(m_ok) {
         m_cwr = (0==mode) ? m_cwr & ~cwrFLASH : m_cwr|cwrFLASH;
-        WrData(adrCWR,m_cwr);
+        SetCwr(cwrFLASH,m_cwr,dspALL);
+      }
+    }
+
+    // turns on/off flash mode for a group of displays
+    // @param mode [0=off, 1=on]
+    // @param dsp  displays, bit[n] = display hid n
+    inline void FlashMode(uint8_t mode, uint16_t dsp) {
+      if(m_ok) {
+        SetCwr(cwrFLASH,(0==mode) ? 0 : cwrFLASH,dsp);
       }
     }
 
-    // turns on blink mode for all displays
-    // @param mode [0=on, 1=off] 
+    // turns on/off blink mode for all displays
+    // @param mode [0=off, 1=on] 
     inline void BlinkMode(uint8_t mode) {
       if(m_ok) {
         m_cwr = (0==mode) ? m_cwr & ~cwrBLINK : m_cwr|cwrBLINK;
-        WrData(adrCWR,m_cwr);
+        SetCwr(cwrBLINK,m_cwr,dspALL);
       }
     }
 
-    // sets the cursor position, new cursor position is limited to maxPOS-1. 
+    // turns on/off blink mode for a group of displays, e.g. an alarm zone
+    // @param mode [0=off, 1=on]
+    // @param dsp  displays, bit[n] = display hid n
+    inline void BlinkMode(uint8_t mode, uint16_t dsp) {
+      if(m_ok) {
+        SetCwr(cwrBLINK,(0==mode) ? 0 : cwrBLINK,dsp);
+      }
+    }
+
+    // gets the control-word of a display from the shadow ram, in async mode
+    // the value is consistent only while the render task is idle
+    // @param hid hdsp2112 identifier [0..nDsp-1]
+    // @return control-word [blink, flash, bright(3)]
+    inline uint8_t GetCwr(uint8_t hid) {
+      return (hid<m_nDsp) ? m_shd[hid].cwr : 0;
+    }
+
+    // turns on/off the automatic flush. With auto flush on (default) every 
+    // call is written to the displays immediately. With auto flush off, the 
+    // calls only update the shadow ram, and a later Flush() writes all 
+    // changed locations to the displays at once.
+    // @param mode [0=off, 1=on]
+    inline void AutoFlush(uint8_t mode) { 
+      m_autoFlush = (0!=mode);
+      if(m_autoFlush) {
+        Flush();
+      }
+    }
+
+    // gets the auto flush mode, see AutoFlush()
+    // @return 1=on 0=off
+    inline bool GetAutoFlush(void) { return m_autoFlush; }
+
+    // writes all locations of the shadow ram, which differ from the content 
+    // of the displays (dirty chars, flash bits, udc chars and control-word). 
+    // In async mode the flush is posted to the render task.
+    void Flush(void);
+
+    // writes all changes like Flush(), but the chars position by position
+    // over all displays instead of display by display. Displays with the
+    // same new char at a position are written by a single cycle with all
+    // their cs low, so all displays change within the same short window,
+    // e.g. a line spanning several displays does not trail. See HdspFrame.
+    void Present(void);
+
+    // turns on/off the async mode. In async mode all calls (print, 
+    // WriteText, SetBrightness, ...) are posted into a lock-free queue and 
+    // return immediately, Service() writes them to the displays. Only a 
+    // single task may post calls. Switch off only while Service() is not 
+    // running, e.g. before StartRenderTask().
+    // @param mode [0=off, 1=on]
+    inline void Async(uint8_t mode) {
+      if((0==mode) && m_async) {
+        postText();                  // chars not yet posted
+        m_async = false;
+        Service();                   // write all posted calls
+      }
+      m_async = (0!=mode);
+    }
+
+    // executes all posted calls and writes the shadow ram to the displays, 
+    // called by the render task or periodically by the user, e.g. on hosts 
+    // without FreeRTOS
+    void Service(void);
+
+#ifdef ESP32
+    // turns on async mode and starts the render task, which is woken up 
+    // by every posted flush and at least every period_ms
+    // @param core      cpu core of render task (default=0, loop() runs on 1)
+    // @param prio      priority of render task
+    // @param period_ms max. period of the render task
+    // @return 1=OK 0=task not created
+    bool StartRenderTask(uint8_t core=0, uint8_t prio=1, uint32_t period_ms=20);
+#endif
+
+    // gets the number of posted calls lost, because the queue was full
+    // @return number of lost calls
+    inline uint32_t GetOverflows(void) { return m_nOverflow; }
+
+    // gets the max. latency from posting a call until the displays are 
+    // written, measured by Service()
+    // @return max. latency [µs]
+    inline uint32_t GetMaxLatency(void) { return m_maxLatency; }
+
+    // sets the cursor position, new cursor position is limited to 
+    // nPOS*nDsp-1. 
     // @param pos the new cursor position 
-    inline void SetPos(uint8_t pos) { m_pos=(pos<maxPOS)? pos : maxPOS-1; }
+    inline void SetPos(uint8_t pos) { m_pos=(pos<m_maxPos)? pos : m_maxPos-1; }
 
     // gets the cursor position
     // @return current cursor postion m_cur
@@ -195,11 +542,21 @@ class HDSP2112 : public Print {
     // translates UTF8 characters into the printable character set of the 
     // HDSP-2112 display, characters in the range [32..127] are passed 
     // directly and e.g. some extended characters like "äöü" are mapped 
-    // to [0..31]
+    // to [0..31], see hdsp2112_utf8.h
     // @param utf8_ch UTF8 character
-    // @return a printable character for the 
+    // @return a printable character for the display, '\0' while a utf8 
+    //         sequence is not yet complete
     uint8_t UTF8_to_HDSP(uint8_t utf8_ch);
 
+    // sets the char printed for utf8 characters, which can't be mapped to 
+    // the character set of the display
+    // @param ch printable character ('\0'=skip these characters)
+    inline void SetFallback(uint8_t ch) { m_utf8.SetFallback(ch); }
+
+    // gets the char printed for utf8 characters, which can't be mapped
+    // @return printable character ('\0'=skip these characters)
+    inline uint8_t GetFallback(void) { return m_utf8.GetFallback(); }
+
     // stores a user defined Font, the characters are filled to the 
     // user defined characters ram within all hdsp2112 displays
     // @param font user defined font with 7 rows 
@@ -211,50 +568,335 @@ class HDSP2112 : public Print {
     // @param idx index in UDC-Ram
     void SetUdChar(const uint8_t *map, const uint8_t idx);
 
+    // gets the number of bus transactions of all chains, e.g. SPI 
+    // transactions sent to the mcp23s17, since the last call of 
+    // ClearTransactions(). A single char costs trnWrData.
+    // @return number of bus transactions
+    inline uint32_t GetTransactions(void) { 
+      uint32_t n=0;
+      for(uint8_t ic=0; ic<m_nChn; ic++) {
+        n += m_bus[ic]->GetTransactions();
+      }
+      return n;
+    }
+
+    // sets the counter of bus transactions of all chains to 0
+    inline void ClearTransactions(void) { 
+      for(uint8_t ic=0; ic<m_nChn; ic++) {
+        m_bus[ic]->ClearTransactions();
+      }
+    }
+
+    // gets the bus backend of a chain
+    // @param ic chain [0..nChn-1]
+    // @return bus backend
+    inline Bus *GetBus(uint8_t ic=0) { return (ic<m_nChn) ? m_bus[ic] : NULL; }
+
+    // gets the character at given position as written by the caller, i.e.
+    // in async mode also chars which are posted but not yet executed. The 
+    // shadow ram is not read, it belongs to the render task in async mode.
+    // @param pos position within display [0..nPOS*nDsp-1]
+    // @return character at position pos 
+    inline uint8_t GetChar(uint8_t pos) { 
+      return (pos<m_maxPos) ? m_chr[pos] : 0; 
+    }
+
 
   protected:
-    // ctrl signals of all displays, by writing "m_ctrl" to U2.PORT_B
-    // m_ctrl = [RES,FL,WR,RD,CS0,CS1,CS2,CS3]
-    inline void setCtrl(void) {
-      m_U2->write8(PORT_B,m_ctrl);
+    // sets bits of the control-word-register of a group of displays, the 
+    // other bits keep their value. A new brightness stops the fades of the
+    // displays. In async mode the bits are posted to the render task.
+    // @param bits bits to set, e.g. cwrBLINK
+    // @param cwr  control-word with the new value of the bits
+    // @param dsp  displays, bit[n] = display hid n
+    void SetCwr(uint8_t bits, uint8_t cwr, uint16_t dsp);
+
+    // checks if a call has to be posted to the render task
+    // @return 1=async mode and not called within Service()
+    inline bool posting(void) { 
+      return m_async && (hdspContext()!=m_service); 
+    }
+
+    // checks if a render task executes the posted calls
+    // @return 1=async mode and render task running 0=calls are executed by
+    //         the caller or by Service() called by the user
+    inline bool rendering(void) {
+#ifdef ESP32
+      return m_async && (NULL!=m_task);
+#else
+      return false;
+#endif
+    }
+
+    // posts a command to the render task, counts lost commands
+    // @param op command cmdXXX
+    // @param a  1st parameter
+    // @param b  2nd parameter
+    // @param v  32 bit parameter
+    // @param p  pointer parameter
+    // @return 1=posted 0=lost, the queue was full
+    inline bool post(uint8_t op, uint8_t a, uint8_t b, uint32_t v=0, const uint8_t *p=NULL) {
+      HdspCmd cmd = { op, a, b, v, p, micros() };
+      if(!m_queue.Push(cmd)) {
+        m_nOverflow++;
+        return false;
+      }
+      return true;
+    }
+
+    // wakes up the render task
+    inline void kick(void) {
+#ifdef ESP32
+      if(NULL!=m_task) {
+        xTaskNotifyGive(m_task);
+      }
+#endif
+    }
+
+    // sink of hdspFormat(), decodes the utf8 text and stores the chars in a
+    // window of the shadow ram (or of m_chr in async mode)
+    class WinSink {
+      public:
+        HDSP2112T<Bus> *m_d;  // driver
+        uint8_t m_pos;        // next position
+        uint8_t m_end;        // end of the window
+        size_t  m_n;          // number of chars of the text
+
+        WinSink(HDSP2112T<Bus> *d, uint8_t pos, uint8_t end) 
+          : m_d(d), m_pos(pos), m_end(end), m_n(0) {}
+
+        // stores a byte of the text
+        // @param c byte
+        inline void Put(char c) {
+          uint8_t ch = m_d->m_utf8.Feed((uint8_t)c);
+          if(0!=ch) {
+            if(m_pos<m_end) {
+              m_d->storeChr(m_pos++,ch);
+            }
+            m_n++;
+          }
+        }
+    };
+
+    // stores a char in the shadow ram, flushed by the caller. In async mode
+    // only m_chr is changed, the next Flush() posts the changed range.
+    // @param pos position within display [0..nPOS*nDsp-1]
+    // @param ch  character
+    inline void storeChr(uint8_t pos, uint8_t ch) {
+      m_chr[pos] = ch;               // chars of the caller, see GetChar()
+      if(!posting()) {
+        putChr(pos,ch);
+      } else if(m_txtHi<=m_txtLo) {
+        m_txtLo = pos;               // first changed char
+        m_txtHi = pos+1;
+      } else {
+        m_txtLo = (pos<m_txtLo) ? pos : m_txtLo;
+        m_txtHi = (pos>=m_txtHi) ? pos+1 : m_txtHi;
+      }
+    }
+
+    // posts the chars changed by the caller as a single command, i.e. a
+    // whole line costs one entry of the queue. The render task reads the 
+    // chars from m_chr, chars changed again meanwhile are posted again. If
+    // the queue is full, the range is kept and posted by the next call.
+    inline void postText(void) {
+      if((m_txtHi>m_txtLo) && post(cmdTEXT,m_txtLo,m_txtHi-m_txtLo)) {
+        m_txtLo = 0;
+        m_txtHi = 0;
+      }
+    }
+
+    // stores a range of the chars of the caller in the shadow ram, marks 
+    // the changed chars dirty, see postText()
+    // @param pos first position [0..nPOS*nDsp-1]
+    // @param n   number of chars
+    inline void putText(uint8_t pos, uint8_t n) {
+      for(uint8_t ic=pos; (ic<pos+n) && (ic<m_maxPos); ic++) {
+        putChr(ic,m_chr[ic]);
+      }
+    }
+
+    // stores a char in the shadow ram, marks it dirty if changed
+    // @param pos position within display [0..nPOS*nDsp-1]
+    // @param ch  character
+    void putChr(uint8_t pos, uint8_t ch);
+
+    // stores bits of the control-word of a group of displays in the shadow 
+    // ram, only displays with a different control-word are marked dirty
+    // @param bits bits to set
+    // @param cwr  control-word with the new value of the bits
+    // @param dsp  displays, bit[n] = display hid n
+    void putCwr(uint8_t bits, uint8_t cwr, uint16_t dsp);
+
+    // starts a fade of a group of displays, see Fade()
+    // @param level [0..7] 0=100% 7=0%
+    // @param ms    duration [ms]
+    // @param dsp   displays, bit[n] = display hid n
+    // @param fade  number of the Fade() call
+    void startFade(uint8_t level, uint16_t ms, uint16_t dsp, uint8_t fade);
+
+    // stops the fades of a group of displays, if their brightness is set
+    // directly. Fading() ends, when no fade is left.
+    // @param bits bits of the control-word, only cwrBRIGHT stops fades
+    // @param dsp  displays, bit[n] = display hid n
+    inline void stopFade(uint8_t bits, uint16_t dsp) {
+      if((bits & cwrBRIGHT) && (m_fadeMask & dsp)) {
+        m_fadeMask &= ~dsp;
+        if(0==m_fadeMask) {
+          m_fadeAck = m_fadeCnt;     // all fades finished, see stepFade()
+        }
+      }
+    }
+
+    // sets the brightness of all fading displays in the shadow ram, the 
+    // displays with the same new level are grouped
+    // @param now current time micros()
+    // @return time until the next level change [µs]
+    uint32_t stepFade(uint32_t now);
+
+    // advances all fades, writes the changed control-words and arms the 
+    // fade timer for the next level change
+    void serviceFade(void);
+
+    // stores the flash bits in the shadow ram, see SetFlashBits()
+    // @param fb  flash bits, MSB=position pos
+    // @param pos first position
+    // @param n   number of chars [1..32]
+    void putFlash(uint32_t fb, uint8_t pos, uint8_t n);
+
+    // stores a user defined char in the shadow ram of all displays
+    // @param map user defined character 5 cols x 7 rows
+    // @param idx index in UDC-Ram
+    void putUdc(const uint8_t *map, const uint8_t idx);
+
+    // resets all displays and sets the control-word
+    // @param cwr  control-word after reset
+    // @param fade number of the last Fade() call, all fades up to it are
+    //             aborted
+    void resetDisplays(uint8_t cwr, uint8_t fade);
+
+    // clears the chars and flash bits of all displays by cwrCLEAR, waits
+    // usCLEAR and writes the control-words again without cwrCLEAR
+    void clearDisplays(void);
+
+    // starts the self test, see StartSelftest()
+    // @param mask     displays to test, bit[n]=1 display n
+    // @param duration duration of the self test [ms]
+    void startTest(uint16_t mask, uint32_t duration);
+
+    // checks if the self test is finished, reads the results and restores
+    // the displays
+    void pollTest(void);
+
+    // writes all user defined chars of a font and resets the displays
+    // @param font user defined font with 7 rows 
+    // @param nChars number of chars
+    // @param cwr  control-word after reset
+    // @param fade number of the last Fade() call, see resetDisplays()
+    void loadFont(const uint8_t *font, uint8_t nChars, uint8_t cwr, uint8_t fade);
+
+    // sets the shadow ram of a single display to the state after a hardware 
+    // reset, i.e. blanks in character-RAM, flash-RAM=0 and control-word=0. 
+    // The UDC-RAM is not affected by a reset.
+    // @param hid hdsp2112 identifier [0..maxDSP-1]
+    void ResetShadow(uint8_t hid);
+
+    // writes the dirty udc chars of all displays, chars with equal content 
+    // in all displays are written to all displays at once
+    void flushUdc(void);
+
+    // writes the dirty control-words of all displays, displays with equal
+    // control-words are written at once
+    void flushCwr(void);
+
+    // writes the dirty flash bits of all displays, FL stays low for all
+    // bits of a chain and the bits of a display are written as a burst
+    void flushFlash(void);
+
+    // writes the dirty chars of all displays. Chars with the same position
+    // and value in several displays are written first, by a single cycle 
+    // with all their cs low. The other chains are written interleaved with
+    // one char per chain and round, the chars of a display as a burst, cs
+    // stays low from the first to the last char.
+    void flushChr(void);
+
+    // writes the dirty chars position by position over all displays, one
+    // cycle per position and distinct char, see Present()
+    // @param min only chars dirty in at least min displays, e.g. 2=only
+    //            chars which are shared by several displays
+    void flushChrPos(uint8_t min=1);
+
+    // end of a frame at the bus backends of all chains, e.g. a queued
+    // backend starts the transfer of the frame
+    inline void commit(void) {
+      for(uint8_t ic=0; ic<m_nChn; ic++) {
+        m_bus[ic]->Commit();
+      }
     }
 
-    // address bus of all displays, by writing "addr" to U1.PORT_A
+    // waits until the bus backends of all chains have sent all
+    // transactions, e.g. before a delay which is counted from the bus
+    inline void sync(void) {
+      for(uint8_t ic=0; ic<m_nChn; ic++) {
+        m_bus[ic]->Sync();
+      }
+    }
+
+    // writes a user defined character to the UDC-RAM of all displays
+    // @param map  user defined character 5 cols x 7 rows
+    // @param idx  index in UDC-Ram
+    // @param rows rows to write, bit[r] = row r
+    void WrUdChar(const uint8_t *map, const uint8_t idx, uint8_t rows=0x7f);
+
+    // chain of a display
+    // @param hid hdsp2112 identifier [0..maxDSP-1]
+    // @return chain [0..maxCHN-1]
+    inline uint8_t chainOf(uint8_t hid) { return hid / nCHNDSP; }
+
+    // cs signal of a display within its chain
+    // @param hid hdsp2112 identifier [0..maxDSP-1]
+    // @return cs mask gpbCS0..gpbCS3
+    inline uint8_t csOf(uint8_t hid) { return gpbCS0 << (hid % nCHNDSP); }
+
+    // ctrl signals of all displays of a chain, by writing "m_ctrl[ic]" to 
+    // the bus, m_ctrl[ic] = [RES,FL,WR,RD,CS0,CS1,CS2,CS3]
+    // @param ic chain
+    inline void setCtrl(uint8_t ic) {
+      m_bus[ic]->SetCtrl(m_ctrl[ic]);
+    }
+
+    // address bus of all displays of a chain
     // @param addr address
-    inline void setAddr(uint8_t addr) {
-      m_U1->write8(PORT_A,addr);
+    // @param ic   chain
+    inline void setAddr(uint8_t addr, uint8_t ic) {
+      m_bus[ic]->SetAddr(addr);
+    };
+
+    // data bus of all displays of a chain
+    // @param data data 
+    // @param ic   chain
+    inline void setData(uint8_t data, uint8_t ic) {
+      m_bus[ic]->SetData(data);
     };
 
-    // data bus of all displays, by writing "data" to U1.PORT_B 
+    // address and data bus of all displays of a chain within a single 
+    // transaction
+    // @param addr address
     // @param data data 
-    inline void setData(uint8_t data) {
-      m_U1->write8(PORT_B,data);
+    // @param ic   chain
+    inline void setAddrData(uint8_t addr, uint8_t data, uint8_t ic) {
+      m_bus[ic]->SetAddrData(addr,data);
     };
 
     // CS signal for a single hdsp2112 display with identifier hid
     // @param mod [0=CS low,1=CS high]
-    // @param hid identifier [0..3], displays are arranged from left to right
+    // @param hid identifier [0..nDsp-1], displays are arranged from left to 
+    //            right
     inline void setCS(uint8_t mod, uint8_t hid) {
       if(m_ok) {
-        switch(hid) {
-          case 0: { // left most display
-            m_ctrl = (0==mod) ? m_ctrl & ~gpbCS0 : m_ctrl | gpbCS0;
-            break;
-          }
-          case 1: { // center left display
-            m_ctrl = (0==mod) ? m_ctrl & ~gpbCS1 : m_ctrl | gpbCS1;
-            break;
-          }
-          case 2: { // center right display
-            m_ctrl = (0==mod) ? m_ctrl & ~gpbCS2 : m_ctrl | gpbCS2;
-            break;
-          }
-          case 3: { // right most display
-            m_ctrl = (0==mod) ? m_ctrl & ~gpbCS3 : m_ctrl | gpbCS3;
-            break;
-          }
-        }
-        setCtrl();
+        uint8_t ic=chainOf(hid);
+        m_ctrl[ic] = (0==mod) ? m_ctrl[ic] & ~csOf(hid) : m_ctrl[ic] | csOf(hid);
+        setCtrl(ic);
       }
     }
     
@@ -262,61 +904,79 @@ class HDSP2112 : public Print {
     // @param mod [0=low,1=high]
     inline void setCS(uint8_t mod) {
       if(m_ok) {
-        if(mod==0) {
-          m_ctrl &= ~gpbCS0 & ~gpbCS1 & ~gpbCS2 & ~gpbCS3;
-        } else {
-          m_ctrl |=  gpbCS0 |  gpbCS1 |  gpbCS2 |  gpbCS3;
+        for(uint8_t ic=0; ic<m_nChn; ic++) {
+          m_ctrl[ic] = (mod==0) ? (m_ctrl[ic] & ~gpbCS) : (m_ctrl[ic] | gpbCS);
+          setCtrl(ic);
         }
-        setCtrl();
       }
     }
 
-    // FL signal for all hdsp2112 displays
+    // FL signal for all hdsp2112 displays of a chain
     // @param mod [0=low,1=high]
-    inline void setFL(uint8_t mod) {
+    // @param ic  chain
+    inline void setFL(uint8_t mod, uint8_t ic) {
       if(m_ok) {
-        m_ctrl = (mod==0) ? (m_ctrl & ~gpbFL) : (m_ctrl | gpbFL);
-        setCtrl();
+        m_ctrl[ic] = (mod==0) ? (m_ctrl[ic] & ~gpbFL) : (m_ctrl[ic] | gpbFL);
+        setCtrl(ic);
       }
     }
 
-    // WR signal for all hdsp2112 displays
+    // WR signal for all hdsp2112 displays of a chain
     // @param mod [0=low,1=high]
-    inline void setWR(uint8_t mod) {
+    // @param ic  chain
+    inline void setWR(uint8_t mod, uint8_t ic) {
       if(m_ok) {
-        m_ctrl = (mod==0) ? (m_ctrl & ~gpbWR) : (m_ctrl | gpbWR);
-        setCtrl();
+        m_ctrl[ic] = (mod==0) ? (m_ctrl[ic] & ~gpbWR) : (m_ctrl[ic] | gpbWR);
+        setCtrl(ic);
       }
     }
 
-    // RD signal for all hdsp2112 displays
+    // RD signal for all hdsp2112 displays of a chain
     // @param mod [0=low,1=high]
-    inline void setRD(uint8_t mod) {
+    // @param ic  chain
+    inline void setRD(uint8_t mod, uint8_t ic) {
       if(m_ok) {
-        m_ctrl = (mod==0) ? (m_ctrl & ~gpbRD) : (m_ctrl | gpbRD);
-        setCtrl();
+        m_ctrl[ic] = (mod==0) ? (m_ctrl[ic] & ~gpbRD) : (m_ctrl[ic] | gpbRD);
+        setCtrl(ic);
       }
     }
 
+    // writes several write cycles, at most one per chain. All chains get 
+    // address and data first, then the cs+wr pulses follow chain by chain, 
+    // so the chains are kept busy in parallel. A cycle with hold=1 keeps cs
+    // low, i.e. a burst of cycles to the same display only pulses wr.
+    // @param wr write cycles
+    // @param n  number of write cycles
+    void WrCycles(const HdspWr *wr, uint8_t n);
+
     // writes data to specific hdsp2112 display with identifier hid
     // @param addr  address
     // @param data  data
-    // @param hid   hdsp2112 identifier [0..3]
-    void WrData(uint8_t addr, uint8_t data, uint8_t hid);
+    // @param hid   hdsp2112 identifier [0..nDsp-1]
+    // @param hold  1=cs stays low, the next cycle is to the same hid
+    void WrData(uint8_t addr, uint8_t data, uint8_t hid, bool hold=false);
 
-    // writes data to all hdsp2112 displays
+    // writes data to all hdsp2112 displays of all chains
     // @param addr  address
     // @param data  data
     void WrData(uint8_t addr, uint8_t data);
 
-    // sets direction of MCP23s17 U1.Port-B, usual the direction is set to 
-    // OUTPUT, e.g. calling a selftest, the direction of U1.PORT-B has to be 
-    // set to INPUT in order to read data from the display. 
+    // writes the same data to a group of hdsp2112 displays at once, the cs
+    // of all displays of a chain are pulsed together
+    // @param addr  address
+    // @param data  data
+    // @param dsp   displays, bit[n] = display hid n
+    void WrGroup(uint8_t addr, uint8_t data, uint16_t dsp);
+
+    // sets direction of the data bus (MCP23s17 U1.Port-B), usual the 
+    // direction is set to OUTPUT, e.g. calling a selftest, the direction of 
+    // the data bus has to be set to INPUT in order to read data from the 
+    // display. 
     // @param mode OUTPUT=write to display, INPUT=read from display
-    inline void DataDirection(uint8_t mode) {
+    // @param ic   chain
+    inline void DataDirection(uint8_t mode, uint8_t ic) {
       if(m_ok) {
-        uint8_t mask=(INPUT==mode) ? 0xff:0x00;
-        m_U1->pinMode8(PORT_B,mask);
+        m_bus[ic]->DataDirection(mode);
       }
     }
 
@@ -325,10 +985,23 @@ class HDSP2112 : public Print {
     // to "reading-data". After reading the data, DataDirection(OUPUT) is 
     // called to set the U1.Port-B to normal "writing-data" again. 
     // @param addr  address to write
-    // @param hid   hdsp2112 identifier [0..1]
+    // @param hid   hdsp2112 identifier [0..nDsp-1]
     // @return data from device
     uint8_t RdData(uint8_t addr,uint8_t hid);
 
+    // reads several registers of a display within a single read run. The
+    // data bus is switched to input once, cs stays low for the whole run
+    // and only rd is pulsed for each register.
+    // @param hid  hdsp2112 identifier [0..nDsp-1]
+    // @param addr addresses of the registers
+    // @param n    number of registers
+    // @param data data read
+    void rdRun(uint8_t hid, const uint8_t *addr, uint8_t n, uint8_t *data);
+
+    // reads back the next display and rewrites the cells which differ from
+    // the shadow ram, see SetScrub()
+    void serviceScrub(void);
+
 
     // ------------------------------------------------------------------------
     // virtual functions, derived from Print class
@@ -347,5 +1020,13 @@ class HDSP2112 : public Print {
 
 };
 
+// default driver, two mcp23s17 at a single SPI chip-select
+using HDSP2112 = HDSP2112T<Mcp23s17Bus>;
+
+#include "hdsp2112_impl.h"
+
+// the default driver is compiled once in hdsp2112.cpp
+extern template class HDSP2112T<Mcp23s17Bus>;
+
 #endif
 
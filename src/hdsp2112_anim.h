@@ -0,0 +1,191 @@
+#ifndef __HDSP2112_ANIM_H__
+#define __HDSP2112_ANIM_H__
+
+// frame based animations of single chars, e.g. spinners and progress
+// indicators made of user defined chars. Each animation shows a sequence
+// of chars at one position, every frame with its own duration. Several
+// animations run at the same time, Tick() does not block: it is called
+// periodically (loop(), a timer task, ...), advances all animations which
+// are due and writes all changed chars with a single flush, i.e. one burst
+// per display. The animator works with every driver HDSP2112T<Bus>.
+//
+//   HdspAnimator<HDSP2112> an(d);
+//   an.Start(10,spin,sizeof(spin),150);       // endless, 150ms per frame
+//   an.Tick();                                // in loop()
+
+#include <stdint.h>
+
+constexpr uint8_t nANIM   = 16;   // max. number of animations
+constexpr uint8_t aniNONE = 0xff; // no animation, e.g. all slots used
+
+// state of a single animation
+struct HdspAnim {
+  const uint8_t  *code;   // chars of the frames, owned by the caller
+  const uint16_t *ms;     // duration of each frame [ms], NULL=period
+  uint16_t period;        // duration of all frames [ms], if ms==NULL
+  uint8_t  n;             // number of frames
+  uint8_t  frame;         // current frame
+  uint8_t  pos;           // position of the char
+  uint8_t  repeat;        // number of runs, 0=endless
+  uint8_t  run;           // completed runs
+  uint8_t  end;           // char after the last run, 0=keep last frame
+  bool     active;        // animation is running
+  bool     wait;          // first frame not yet shown (start delay)
+  uint32_t next;          // time of the next frame micros()
+};
+
+template<class Drv>
+class HdspAnimator {
+  private:
+    Drv *m_drv;             // driver
+    HdspAnim m_ani[nANIM];  // animations
+
+  public:
+    // constructor
+    // @param drv driver
+    HdspAnimator(Drv &drv) {
+      m_drv = &drv;
+      for(uint8_t ia=0; ia<nANIM; ia++) {
+        m_ani[ia].active = false;
+      }
+    }
+
+    // starts an animation with the same duration for all frames, the
+    // first frame is shown by the next Tick() after the start delay
+    // @param pos      position of the char
+    // @param code     chars of the frames, must be valid until the end
+    // @param n        number of frames
+    // @param period   duration of each frame [ms], 0 is taken as 1ms
+    // @param repeat   number of runs, 0=endless
+    // @param end      char shown after the last run, 0=keep last frame
+    // @param delay_ms start delay [ms]
+    // @return handle of the animation, aniNONE=all slots used
+    inline uint8_t Start(uint8_t pos, const uint8_t *code, uint8_t n,
+                         uint16_t period, uint8_t repeat=0, uint8_t end=0,
+                         uint32_t delay_ms=0) {
+      return start(pos,code,n,NULL,period,repeat,end,delay_ms);
+    }
+
+    // starts an animation with its own duration for every frame
+    // @param pos      position of the char
+    // @param code     chars of the frames, must be valid until the end
+    // @param ms       duration of each frame [ms], must be valid until the end,
+    //                 0 is taken as 1ms
+    // @param n        number of frames
+    // @param repeat   number of runs, 0=endless
+    // @param end      char shown after the last run, 0=keep last frame
+    // @param delay_ms start delay [ms]
+    // @return handle of the animation, aniNONE=all slots used
+    inline uint8_t Start(uint8_t pos, const uint8_t *code, const uint16_t *ms,
+                         uint8_t n, uint8_t repeat=0, uint8_t end=0,
+                         uint32_t delay_ms=0) {
+      return start(pos,code,n,ms,0,repeat,end,delay_ms);
+    }
+
+    // stops an animation, the char keeps the current frame
+    // @param h handle of the animation
+    inline void Stop(uint8_t h) {
+      if(h<nANIM) {
+        m_ani[h].active = false;
+      }
+    }
+
+    // stops all animations
+    inline void StopAll(void) {
+      for(uint8_t ia=0; ia<nANIM; ia++) {
+        m_ani[ia].active = false;
+      }
+    }
+
+    // checks if an animation is running
+    // @param h handle of the animation, aniNONE=any animation
+    // @return 1=running 0=stopped
+    inline bool Busy(uint8_t h=aniNONE) {
+      if(h<nANIM) {
+        return m_ani[h].active;
+      }
+      for(uint8_t ia=0; ia<nANIM; ia++) {
+        if(m_ani[ia].active) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    // advances all animations which are due, several missed frames are
+    // skipped. The changed chars of all animations are flushed at once.
+    // @param now current time micros()
+    // @return number of animations which changed their char
+    uint8_t Tick(uint32_t now=micros()) {
+      uint8_t nUpd=0;
+      bool af=m_drv->GetAutoFlush();
+      uint8_t cur=m_drv->GetPos();
+      for(uint8_t ia=0; ia<nANIM; ia++) {
+        HdspAnim &a = m_ani[ia];
+        bool upd=false;
+        for(uint16_t k=0; a.active && ((int32_t)(now-a.next) >= 0); k++) {
+          if(k>a.n) {
+            a.next = now;              // far behind, don't catch up
+          }
+          if(a.wait) {
+            a.wait = false;            // start delay elapsed
+          } else if(++a.frame >= a.n) {
+            a.frame = 0;               // next run
+            if((a.repeat>0) && (++a.run >= a.repeat)) {
+              a.active = false;
+              a.frame  = a.n-1;
+            }
+          }
+          uint16_t dur = (NULL!=a.ms) ? a.ms[a.frame] : a.period;
+          a.next += 1000ul * ((dur>0) ? dur : 1); // 0 would never be due
+          upd = true;
+        }
+        if(upd) {
+          if(0==nUpd++) {
+            m_drv->AutoFlush(0);       // collect all chars, single flush
+          }
+          uint8_t ch = a.code[a.frame];
+          m_drv->WriteChar(a.pos,(a.active || (0==a.end)) ? ch : a.end);
+        }
+      }
+      if(nUpd>0) {
+        m_drv->SetPos(cur);            // keep the cursor of the caller
+        if(af) {
+          m_drv->AutoFlush(1);         // unchanged chars are not written
+        }
+      }
+      return nUpd;
+    }
+
+  protected:
+    // starts an animation in a free slot
+    uint8_t start(uint8_t pos, const uint8_t *code, uint8_t n,
+                  const uint16_t *ms, uint16_t period, uint8_t repeat,
+                  uint8_t end, uint32_t delay_ms) {
+      if((NULL==code) || (0==n)) {
+        return aniNONE;
+      }
+      for(uint8_t ia=0; ia<nANIM; ia++) {
+        HdspAnim &a = m_ani[ia];
+        if(!a.active) {
+          a.code   = code;
+          a.ms     = ms;
+          a.period = period;
+          a.n      = n;
+          a.frame  = 0;
+          a.pos    = pos;
+          a.repeat = repeat;
+          a.run    = 0;
+          a.end    = end;
+          a.wait   = true;
+          a.next   = micros() + delay_ms * 1000ul;
+          a.active = true;
+          return ia;
+        }
+      }
+      return aniNONE;
+    }
+};
+
+#endif
+//__HDSP2112_ANIM_H__
@@ -0,0 +1,204 @@
+#ifndef __HDSP2112_BUS_H__
+#define __HDSP2112_BUS_H__
+
+// bus backends of the HDSP2112T<Bus> driver. A backend drives the parallel
+// bus of all hdsp2112 displays (address, data, control signals). The driver
+// is specialized on the backend at compile time, so all calls are inlined
+// without virtual dispatch. A backend provides the following members:
+//
+//   bool     Ok(void)                             backend is usable
+//   void     Begin(void)                          init hardware, all outputs
+//   void     SetCtrl(uint8_t ctrl)                [RES,FL,WR,RD,CS0..CS3]
+//   void     PulseCtrl(uint8_t c, uint8_t next)   ctrl=c, then ctrl=next
+//   void     SetAddr(uint8_t addr)                address bus a[0..4]
+//   void     SetData(uint8_t data)                data bus d[0..7]
+//   void     SetAddrData(uint8_t a, uint8_t d)    address and data bus
+//   void     DataDirection(uint8_t mode)          data bus INPUT/OUTPUT
+//   uint8_t  GetData(void)                        read data bus
+//   void     Commit(void)                         end of a frame (Flush)
+//   void     Sync(void)                           wait until all are sent
+//
+// A backend may queue the writes (e.g. Mcp23s17DmaBus), the order at the
+// bus is kept. The driver calls Sync() before its delays (reset, clear,
+// read runs), GetData() waits for the queue itself.
+//   uint32_t GetTransactions(void)                number of bus transactions
+//   void     ClearTransactions(void)              clear the counter
+
+#include "MCP23S17.h"
+#include "hdsp2112_prof.h"
+
+///< use the standard ESP32 SPI ports (SPI_CLK=18, SPI_MOSI=23, SPI_MISO=19)
+constexpr int8_t SPI_clk   = 18;             // SPI clock
+constexpr int8_t SPI_mosi  = 23;             // SPI master-out-slave-in
+constexpr int8_t SPI_miso  = 19;             // SPI master-in-slave-out
+
+///< two mcp23s17 are connected in parallel using HAEN and addresses 1 and 7
+constexpr uint8_t U1_addr  = 0b00000001;     // 0b001=0x1 --> register=0x21
+constexpr uint8_t U2_addr  = 0b00000111;     // 0b111=0x7 --> register=0x27
+constexpr uint8_t PORT_A   = 0;              // Port-A = Pin[21..28]
+constexpr uint8_t PORT_B   = 1;              // Port-B = Pin[ 1.. 8]
+
+///< mcp23s17 SPI protocol (IOCON.BANK=0), used for raw transactions
+constexpr uint8_t mcpWRITE = 0b01000000;     // opcode write, | (addr<<1)
+constexpr uint8_t mcpGPIOB = 0x13;           // register GPIOB
+
+// backend with two mcp23s17 port expander sharing a single SPI chip-select
+// U1.PORT_A = address bus, U1.PORT_B = data bus, U2.PORT_B = control signals
+class Mcp23s17Bus {
+  private:
+    MCP23S17 *m_U1;     // PORT_A[0..4]=addr[0..4] PORT_B[0..7]=data[0..7]
+    MCP23S17 *m_U2;     // PORT_B[0..7]=[res,fl,wr,rd,cs0,cs1,cs2,cs3]
+    bool m_ok;          // 1=(U1 and U2 are valid)  0=(alloc failed)
+
+    int8_t m_spi_cs;    // SPI chip-select
+    int8_t m_spi_clk;   // SPI clock
+    int8_t m_spi_mosi;  // SPI master-out-clock-in
+    int8_t m_spi_miso;  // SPI master-in-clock-out
+    uint8_t m_u2_addr;  // hardware address of U2
+
+    uint32_t m_nTrn;    // number of SPI transactions to U1 and U2
+
+  public:
+    // constructor
+    // @param spi_cs    chip select
+    // @param spi_clk   spi-clock           (default=VSPI)
+    // @param spi_mosi  master-out-slave-in (default=VSPI)
+    // @param spi_miso  master-in-slave-out (default=VSPI)
+    // @param u1_addr   hardware address of U1 (address and data bus)
+    // @param u2_addr   hardware address of U2 (control signals)
+    Mcp23s17Bus(const int8_t spi_cs,
+                const int8_t spi_clk  = SPI_clk,
+                const int8_t spi_mosi = SPI_mosi,
+                const int8_t spi_miso = SPI_miso,
+                const uint8_t u1_addr = U1_addr,
+                const uint8_t u2_addr = U2_addr) {
+      m_spi_cs   = spi_cs;                    // SPI chipselect
+      m_spi_clk  = spi_clk;                   // SPI clock
+      m_spi_mosi = spi_mosi;                  // SPI master-out-slave-in
+      m_spi_miso = spi_miso;                  // SPI master-in-slave-out
+      m_u2_addr  = u2_addr;                   // U2 for raw transactions
+      m_nTrn = 0;                             // no SPI transactions yet
+      m_U1 = new MCP23S17(m_spi_cs,u1_addr);  // device U1 from schematic
+      m_U2 = new MCP23S17(m_spi_cs,u2_addr);  // device U2 from schematic
+      m_ok = (m_U1 && m_U2)? true: false;     // set m_ok==true if U1,U2 valid
+    }
+
+    // destructor
+    // frees the two dynamic allocated MCP23S17 instances m_U1 and m_U2
+    inline ~Mcp23s17Bus() {
+      if(NULL!=m_U1) {
+        delete m_U1;
+        m_U1=NULL;
+      }
+      if(NULL!=m_U2) {
+        delete m_U2;
+        m_U2=NULL;
+      }
+      m_ok=false;
+    }
+
+    // @return 1=(U1 and U2 are valid)  0=(alloc failed)
+    inline bool Ok(void) { return m_ok; }
+
+    // inits the SPI bus and the two mcp23s17
+    inline void Begin(void) {
+      if(m_ok) {
+        SPI.begin(m_spi_clk,m_spi_miso,m_spi_mosi,m_spi_cs);
+        m_U1->begin();
+        m_U1->enableHardwareAddress(); // enable HAEN function
+        m_U1->pinMode16(0);            // set all pins to OUTPUT
+        m_U2->begin();
+        m_U2->enableHardwareAddress(); // enable HAEN function
+        m_U2->pinMode16(0);            // set all pins to OUTPUT
+      }
+    }
+
+    // ctrl signals of all displays, by writing "ctrl" to U2.PORT_B
+    // @param ctrl [RES,FL,WR,RD,CS0,CS1,CS2,CS3]
+    inline void SetCtrl(uint8_t ctrl) {
+      m_U2->write8(PORT_B,ctrl);
+      m_nTrn++;
+      hdspProfTrn(3); // opcode, register, 1 data byte
+    }
+
+    // two states of the ctrl signals within a single SPI transaction, e.g. 
+    // a wr pulse. In byte mode (IOCON.SEQOP=1, set by begin()) the register
+    // pointer toggles between GPIOB and GPIOA, so the bytes are written to 
+    // U2.PORT_B, U2.PORT_A (not connected) and U2.PORT_B. The pulse lasts 
+    // 16 SPI clocks (2µs at 8MHz), the wr pulse width has to be >=100ns.
+    // @param ctrl first state  [RES,FL,WR,RD,CS0,CS1,CS2,CS3]
+    // @param next second state [RES,FL,WR,RD,CS0,CS1,CS2,CS3]
+    inline void PulseCtrl(uint8_t ctrl, uint8_t next) {
+      SPI.beginTransaction(SPISettings(m_U2->getSPIspeed(),MSBFIRST,SPI_MODE0));
+      digitalWrite(m_spi_cs,LOW);
+      SPI.transfer(mcpWRITE | (m_u2_addr<<1)); // opcode with address of U2
+      SPI.transfer(mcpGPIOB);                 // first register
+      SPI.transfer(ctrl);                     // U2.PORT_B
+      SPI.transfer(next);                     // U2.PORT_A, don't care
+      SPI.transfer(next);                     // U2.PORT_B
+      digitalWrite(m_spi_cs,HIGH);
+      SPI.endTransaction();
+      m_nTrn++;
+      hdspProfTrn(5); // opcode, register, 3 data bytes
+    }
+
+    // address bus of all displays, by writing "addr" to U1.PORT_A
+    // @param addr address
+    inline void SetAddr(uint8_t addr) {
+      m_U1->write8(PORT_A,addr);
+      m_nTrn++;
+      hdspProfTrn(3); // opcode, register, 1 data byte
+    }
+
+    // data bus of all displays, by writing "data" to U1.PORT_B
+    // @param data data
+    inline void SetData(uint8_t data) {
+      m_U1->write8(PORT_B,data);
+      m_nTrn++;
+      hdspProfTrn(3); // opcode, register, 1 data byte
+    }
+
+    // address and data bus of all displays within a single SPI transaction,
+    // write16() sends the high byte to U1.PORT_A and the low byte to
+    // U1.PORT_B (with IOCON.BANK=0 the register pointer moves from GPIOA to
+    // GPIOB in sequential as well as in byte mode)
+    // @param addr address
+    // @param data data
+    inline void SetAddrData(uint8_t addr, uint8_t data) {
+      m_U1->write16(((uint16_t)addr<<8) | data);
+      m_nTrn++;
+      hdspProfTrn(4); // opcode, register, 2 data bytes
+    }
+
+    // sets direction of U1.PORT_B
+    // @param mode OUTPUT=write to display, INPUT=read from display
+    inline void DataDirection(uint8_t mode) {
+      uint8_t mask=(INPUT==mode) ? 0xff:0x00;
+      m_U1->pinMode8(PORT_B,mask);
+      m_nTrn++;
+      hdspProfTrn(3); // opcode, register, 1 data byte
+    }
+
+    // reads the data bus from U1.PORT_B
+    // @return data
+    inline uint8_t GetData(void) {
+      m_nTrn++;
+      hdspProfTrn(3); // opcode, register, 1 data byte
+      return (uint8_t)m_U1->read8(PORT_B);
+    }
+
+    // end of a frame, nothing to do, all transactions are already sent
+    inline void Commit(void) { }
+
+    // waits until all transactions are sent, nothing to do
+    inline void Sync(void) { }
+
+    // @return number of SPI transactions sent to U1 and U2
+    inline uint32_t GetTransactions(void) { return m_nTrn; }
+
+    // sets the counter of SPI transactions to 0
+    inline void ClearTransactions(void) { m_nTrn = 0; }
+};
+
+#endif
+//__HDSP2112_BUS_H__
@@ -0,0 +1,358 @@
+#ifndef __HDSP2112_BUS_DMA_H__
+#define __HDSP2112_BUS_DMA_H__
+
+// bus backend of the HDSP2112T<Bus> driver with queued SPI transactions of
+// the ESP32 SPI master (ESP-IDF driver, DMA). Same wiring as Mcp23s17Bus,
+// but the mcp23s17 commands (opcode, register, data) of a frame are only
+// built into a ring of transactions in DMA capable memory. Commit(), called
+// by the driver at the end of each Flush(), hands the frame to the SPI
+// driver, which sends it in the background, the cpu does not wait for the
+// bus. A callback signals the end of the frame.
+//
+//   Mcp23s17DmaBus bus(5);
+//   HDSP2112T<Mcp23s17DmaBus> d(&bus);
+//   bus.SetDoneCallback(done,NULL);   // called by the SPI interrupt
+//
+// The ctrl signals (SetCtrl, e.g. FL) are queued like all writes, the order
+// at the bus is kept, i.e. a Flush() with flash bits does not block. Reads
+// wait until all queued transactions are sent, and the driver calls Sync()
+// before its delays (reset, clear, read runs), so they are still counted
+// from the bus and not from the queue.
+//
+// Scope: the mcp23s17 takes the opcode after the falling edge of its SPI
+// chip-select, i.e. every command (3-5 bytes) needs a SPI frame of its own,
+// and the commands to U1 (address, data) and U2 (wr, cs) alternate. The
+// SPI master of the ESP32 can't toggle the chip-select within a
+// transaction, so a frame of the driver can't be sent as a single DMA
+// descriptor chain. Every command is a transaction queued by
+// spi_device_queue_trans() and finished by an interrupt: the cpu does not
+// wait for the bus, but it pays the queue call and the interrupt per
+// command, which is in the order of a short polling transfer at 8MHz. The
+// saving depends on the SPI clock, env:bench_dma measures it against
+// env:bench ("us" is the cpu time of the calls).
+//
+// The SPI bus is initialized by Begin(), or shared if it is already
+// initialized (with DMA) for other devices. It is only freed by the
+// destructor, if this backend has initialized it.
+
+#ifdef ESP32
+
+#include <string.h>
+#include <driver/spi_master.h>
+#include <esp_heap_caps.h>
+#include "hdsp2112.h"
+
+constexpr uint8_t nDMATRN   = 128;           // transactions of the ring
+constexpr uint8_t dmaBYTES  = 8;             // bytes per transaction buffer
+
+///< mcp23s17 registers (IOCON.BANK=0) and IOCON bits, used by Begin()
+constexpr uint8_t mcpREAD   = 0b01000001;    // opcode read, | (addr<<1)
+constexpr uint8_t mcpIODIRA = 0x00;          // register IODIRA
+constexpr uint8_t mcpIODIRB = 0x01;          // register IODIRB
+constexpr uint8_t mcpIOCON  = 0x0a;          // register IOCON
+constexpr uint8_t mcpGPIOA  = 0x12;          // register GPIOA
+constexpr uint8_t mcpSEQOP  = 0x20;          // IOCON byte mode
+constexpr uint8_t mcpHAEN   = 0x08;          // IOCON hardware address
+
+// backend with two mcp23s17 port expander sharing a single SPI chip-select,
+// all writes are queued transactions of the ESP32 SPI master
+class Mcp23s17DmaBus {
+  private:
+    spi_host_device_t   m_host;   // SPI host, e.g. SPI3_HOST (VSPI)
+    spi_device_handle_t m_dev;    // mcp23s17 pair at the SPI bus
+    bool m_ownBus;      // 1=SPI bus initialized by Begin() 0=shared
+    spi_transaction_t m_trn[nDMATRN]; // ring of transactions
+    uint8_t *m_buf;     // tx bytes of the ring, DMA capable memory
+    bool m_ok;          // 1=(buffer and SPI bus are valid)  0=(failed)
+
+    int8_t m_spi_cs;    // SPI chip-select
+    int8_t m_spi_clk;   // SPI clock
+    int8_t m_spi_mosi;  // SPI master-out-clock-in
+    int8_t m_spi_miso;  // SPI master-in-clock-out
+    uint8_t m_u1_addr;  // hardware address of U1
+    uint8_t m_u2_addr;  // hardware address of U2
+    uint32_t m_hz;      // SPI clock [Hz]
+
+    uint32_t m_head;    // transactions built
+    uint32_t m_sent;    // transactions handed to the SPI driver
+    uint32_t m_done;    // transactions finished and taken back
+    volatile uint32_t m_fin;   // transactions finished, counted by the isr
+    volatile uint32_t m_frame; // end of the committed frame
+    volatile bool m_armed;     // 1=callback at the end of the frame
+    portMUX_TYPE m_mux;        // guards m_fin, m_frame and m_armed
+    void (*m_cb)(void *);      // end of frame callback
+    void *m_arg;               // parameter of the callback
+
+    uint32_t m_nTrn;    // number of SPI transactions to U1 and U2
+
+  public:
+    // constructor
+    // @param spi_cs    chip select
+    // @param spi_clk   spi-clock           (default=VSPI)
+    // @param spi_mosi  master-out-slave-in (default=VSPI)
+    // @param spi_miso  master-in-slave-out (default=VSPI)
+    // @param u1_addr   hardware address of U1 (address and data bus)
+    // @param u2_addr   hardware address of U2 (control signals)
+    // @param host      SPI host of the ESP32
+    // @param hz        SPI clock [Hz], mcp23s17 max. 10MHz
+    Mcp23s17DmaBus(const int8_t spi_cs,
+                   const int8_t spi_clk  = SPI_clk,
+                   const int8_t spi_mosi = SPI_mosi,
+                   const int8_t spi_miso = SPI_miso,
+                   const uint8_t u1_addr = U1_addr,
+                   const uint8_t u2_addr = U2_addr,
+                   const spi_host_device_t host = SPI3_HOST,
+                   const uint32_t hz = 8000000) {
+      m_host     = host;
+      m_dev      = NULL;
+      m_ownBus   = false;
+      m_spi_cs   = spi_cs;
+      m_spi_clk  = spi_clk;
+      m_spi_mosi = spi_mosi;
+      m_spi_miso = spi_miso;
+      m_u1_addr  = u1_addr;
+      m_u2_addr  = u2_addr;
+      m_hz       = hz;
+      m_head  = m_sent = m_done = 0;
+      m_fin   = 0;
+      m_frame = 0;
+      m_armed = false;
+      portMUX_INITIALIZE(&m_mux);
+      m_cb    = NULL;
+      m_arg   = NULL;
+      m_nTrn  = 0;
+      m_buf = (uint8_t *)heap_caps_malloc(nDMATRN*dmaBYTES,MALLOC_CAP_DMA);
+      m_ok  = (NULL!=m_buf);
+    }
+
+    // destructor
+    // waits for the queued transactions, removes the device and frees the
+    // SPI bus, if initialized by Begin()
+    inline ~Mcp23s17DmaBus() {
+      if(NULL!=m_dev) {
+        sync();
+        spi_bus_remove_device(m_dev);
+        m_dev=NULL;
+      }
+      if(m_ownBus) {
+        spi_bus_free(m_host);  // no other device at the bus
+        m_ownBus=false;
+      }
+      if(NULL!=m_buf) {
+        heap_caps_free(m_buf);
+        m_buf=NULL;
+      }
+      m_ok=false;
+    }
+
+    // @return 1=(buffer and SPI bus are valid)  0=(failed)
+    inline bool Ok(void) { return m_ok; }
+
+    // inits the SPI bus with DMA (unless initialized for other devices) and
+    // the two mcp23s17
+    inline void Begin(void) {
+      if(m_ok) {
+        spi_bus_config_t bus = {};
+        bus.mosi_io_num     = m_spi_mosi;
+        bus.miso_io_num     = m_spi_miso;
+        bus.sclk_io_num     = m_spi_clk;
+        bus.quadwp_io_num   = -1;
+        bus.quadhd_io_num   = -1;
+        bus.max_transfer_sz = dmaBYTES;
+        spi_device_interface_config_t dev = {};
+        dev.mode           = 0;
+        dev.clock_speed_hz = m_hz;
+        dev.spics_io_num   = m_spi_cs;
+        dev.queue_size     = nDMATRN;
+        dev.post_cb        = postCb;
+        esp_err_t err = spi_bus_initialize(m_host,&bus,SPI_DMA_CH_AUTO);
+        m_ownBus = (ESP_OK==err);      // else already initialized, shared
+        m_ok = (m_ownBus || (ESP_ERR_INVALID_STATE==err)) &&
+               (ESP_OK==spi_bus_add_device(m_host,&dev,&m_dev));
+      }
+      if(m_ok) {
+        // HAEN=0 after power up, all mcp23s17 take the first IOCON write
+        const uint8_t addr[2] = { m_u1_addr, m_u2_addr };
+        for(uint8_t iu=0; iu<2; iu++) {
+          uint8_t op = mcpWRITE | (addr[iu]<<1);
+          put(op,mcpIOCON,mcpSEQOP|mcpHAEN,0,0,3);   // byte mode, HAEN
+          put(op,mcpIODIRA,0x00,0x00,0,4);           // all pins OUTPUT
+        }
+        sync();
+      }
+    }
+
+    // ctrl signals of all displays, by writing "ctrl" to U2.PORT_B. Queued
+    // like all writes, Sync() waits until the signals are set.
+    // @param ctrl [RES,FL,WR,RD,CS0,CS1,CS2,CS3]
+    inline void SetCtrl(uint8_t ctrl) {
+      put(mcpWRITE | (m_u2_addr<<1),mcpGPIOB,ctrl,0,0,3);
+    }
+
+    // two states of the ctrl signals within a single SPI transaction, e.g.
+    // a wr pulse, see Mcp23s17Bus::PulseCtrl()
+    // @param ctrl first state  [RES,FL,WR,RD,CS0,CS1,CS2,CS3]
+    // @param next second state [RES,FL,WR,RD,CS0,CS1,CS2,CS3]
+    inline void PulseCtrl(uint8_t ctrl, uint8_t next) {
+      put(mcpWRITE | (m_u2_addr<<1),mcpGPIOB,ctrl,next,next,5);
+    }
+
+    // address bus of all displays, by writing "addr" to U1.PORT_A
+    // @param addr address
+    inline void SetAddr(uint8_t addr) {
+      put(mcpWRITE | (m_u1_addr<<1),mcpGPIOA,addr,0,0,3);
+    }
+
+    // data bus of all displays, by writing "data" to U1.PORT_B
+    // @param data data
+    inline void SetData(uint8_t data) {
+      put(mcpWRITE | (m_u1_addr<<1),mcpGPIOB,data,0,0,3);
+    }
+
+    // address and data bus of all displays within a single SPI transaction
+    // @param addr address
+    // @param data data
+    inline void SetAddrData(uint8_t addr, uint8_t data) {
+      put(mcpWRITE | (m_u1_addr<<1),mcpGPIOA,addr,data,0,4);
+    }
+
+    // sets direction of U1.PORT_B
+    // @param mode OUTPUT=write to display, INPUT=read from display
+    inline void DataDirection(uint8_t mode) {
+      uint8_t mask=(INPUT==mode) ? 0xff:0x00;
+      put(mcpWRITE | (m_u1_addr<<1),mcpIODIRB,mask,0,0,3);
+    }
+
+    // reads the data bus from U1.PORT_B, after all queued transactions
+    // @return data
+    inline uint8_t GetData(void) {
+      if(!m_ok) {
+        return 0;
+      }
+      sync();                    // polling needs an empty queue
+      spi_transaction_t t = {};
+      t.flags      = SPI_TRANS_USE_TXDATA | SPI_TRANS_USE_RXDATA;
+      t.length     = 24;
+      t.tx_data[0] = mcpREAD | (m_u1_addr<<1);
+      t.tx_data[1] = mcpGPIOB;
+      spi_device_polling_transmit(m_dev,&t);
+      m_nTrn++;
+      hdspProfTrn(3); // opcode, register, 1 data byte
+      return t.rx_data[2];
+    }
+
+    // end of a frame, hands all built transactions to the SPI driver and
+    // returns at once. The callback is called when the frame is sent.
+    inline void Commit(void) {
+      if(m_ok) {
+        portENTER_CRITICAL(&m_mux);
+        bool now = (m_fin==m_head);    // nothing left of this frame
+        m_frame = m_head;
+        m_armed = !now;
+        portEXIT_CRITICAL(&m_mux);
+        if(now && (NULL!=m_cb)) {
+          m_cb(m_arg);
+        }
+        submit();
+      }
+    }
+
+    // waits until all transactions are sent
+    inline void Sync(void) { sync(); }
+
+    // checks if transactions are built or queued
+    // @return 1=busy 0=all transactions sent
+    inline bool Busy(void) { return m_fin!=m_head; }
+
+    // sets the callback at the end of a frame. It is called by the SPI
+    // interrupt, i.e. it has to be short and in IRAM, e.g. give a semaphore.
+    // @param cb  callback, NULL=none
+    // @param arg parameter of the callback
+    inline void SetDoneCallback(void (*cb)(void *), void *arg=NULL) {
+      m_cb  = cb;
+      m_arg = arg;
+    }
+
+    // @return number of SPI transactions sent to U1 and U2
+    inline uint32_t GetTransactions(void) { return m_nTrn; }
+
+    // sets the counter of SPI transactions to 0
+    inline void ClearTransactions(void) { m_nTrn = 0; }
+
+  protected:
+    // appends a transaction to the ring, a full ring is handed to the SPI
+    // driver and the oldest transaction is taken back
+    // @param b0..b4 bytes of the transaction
+    // @param n      number of bytes
+    inline void put(uint8_t b0, uint8_t b1, uint8_t b2, uint8_t b3,
+                    uint8_t b4, uint8_t n) {
+      if(!m_ok) {
+        return;
+      }
+      if(m_head-m_done >= nDMATRN) {
+        submit();
+        fetch();
+      }
+      uint8_t it = m_head % nDMATRN;
+      uint8_t *buf = m_buf + it*dmaBYTES;
+      buf[0]=b0; buf[1]=b1; buf[2]=b2; buf[3]=b3; buf[4]=b4;
+      spi_transaction_t &t = m_trn[it];
+      memset(&t,0,sizeof(t));
+      t.length    = 8*n;
+      t.tx_buffer = buf;
+      t.user      = this;
+      m_head++;
+      m_nTrn++;
+      hdspProfTrn(n);
+    }
+
+    // hands the built transactions to the SPI driver
+    inline void submit(void) {
+      for(; m_sent!=m_head; m_sent++) {
+        spi_device_queue_trans(m_dev,&m_trn[m_sent % nDMATRN],portMAX_DELAY);
+      }
+    }
+
+    // takes back the oldest finished transaction, waits if necessary
+    inline void fetch(void) {
+      spi_transaction_t *t;
+      spi_device_get_trans_result(m_dev,&t,portMAX_DELAY);
+      m_done++;
+    }
+
+    // sends all transactions and waits until they are finished
+    inline void sync(void) {
+      if(m_ok) {
+        submit();
+        while(m_done!=m_sent) {
+          fetch();
+        }
+      }
+    }
+
+    // called by the SPI interrupt after each transaction
+    static void IRAM_ATTR postCb(spi_transaction_t *t) {
+      Mcp23s17DmaBus *b = (Mcp23s17DmaBus *)t->user;
+      if(NULL!=b) {
+        bool done;
+        portENTER_CRITICAL_ISR(&b->m_mux);
+        b->m_fin++;
+        done = b->m_armed && (b->m_fin==b->m_frame);
+        b->m_armed = b->m_armed && !done;
+        portEXIT_CRITICAL_ISR(&b->m_mux);
+        if(done && (NULL!=b->m_cb)) {
+          b->m_cb(b->m_arg);
+        }
+      }
+    }
+};
+
+// driver with the DMA backend, compiled once in hdsp2112.cpp
+using HDSP2112Dma = HDSP2112T<Mcp23s17DmaBus>;
+extern template class HDSP2112T<Mcp23s17DmaBus>;
+
+#endif
+//ESP32
+
+#endif
+//__HDSP2112_BUS_DMA_H__
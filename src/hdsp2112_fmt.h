@@ -0,0 +1,258 @@
+#ifndef __HDSP2112_FMT_H__
+#define __HDSP2112_FMT_H__
+
+// printf style formatter of the HDSP2112T<Bus> driver, which writes the
+// formatted text byte by byte into a sink instead of a buffer, e.g. into
+// the shadow ram of the displays. A sink is any class with a method
+// Put(char). Literal text, %s and %c are streamed directly, only the
+// digits of a single numeric conversion pass a scratch (fmtTMP), which 
+// holds the longest line of the driver (maxCHR chars). Digits behind it 
+// are dropped, they are never shown.
+//
+//   HdspCount cnt(0);
+//   hdspFormat(cnt,"T=%5.1f",args);   // cnt.m_n = number of chars
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hdsp2112_utf8.h"
+
+constexpr uint8_t fmtTMP = 129;  // scratch of a single numeric conversion,
+                                 // maxCHR chars and the terminator
+
+// alignment of a text within a window, see WriteField()
+constexpr uint8_t alLEFT   = 0;
+constexpr uint8_t alRIGHT  = 1;
+constexpr uint8_t alCENTER = 2;
+
+// sink, which counts the chars of a formatted utf8 text
+class HdspCount {
+  public:
+    HdspUtf8 m_utf8;    // utf8 decoder, independent of the driver
+    size_t   m_n;       // number of chars
+
+    // constructor
+    // @param fallback char for code points without glyph (0=skip)
+    HdspCount(uint8_t fallback) : m_n(0) { m_utf8.SetFallback(fallback); }
+
+    // counts a byte of the text
+    // @param c byte
+    inline void Put(char c) {
+      if(0!=m_utf8.Feed((uint8_t)c)) {
+        m_n++;
+      }
+    }
+};
+
+// writes a char n times
+// @param out sink
+// @param c   char
+// @param n   number of chars
+template<class Sink>
+inline void fmtPad(Sink &out, char c, int n) {
+  for(; n>0; n--) {
+    out.Put(c);
+  }
+}
+
+// appends a decimal number to a conversion spec
+// @param sp  spec
+// @param k   length of the spec
+// @param v   number >=0
+// @return new length of the spec
+inline uint8_t fmtNum(char *sp, uint8_t k, int v) {
+  char d[10];
+  uint8_t n=0;
+  do {
+    d[n++] = '0' + v%10;
+    v /= 10;
+  } while(v>0);
+  while(n>0) {
+    sp[k++] = d[--n];
+  }
+  return k;
+}
+
+// formats a text printf() like into a sink. Supports the flags -+ #0,
+// width and precision (also *), the length modifiers hh h l ll z j t L
+// and the conversions d i u o x X f F e E g G a A c s p %. The width of
+// %s and %c counts utf8 chars instead of bytes. A numeric conversion is
+// cut behind fmtTMP-1 chars, the padding follows its full length.
+// @param out  sink
+// @param fmt  printf style format string
+// @param args variable parameters
+template<class Sink>
+void hdspFormat(Sink &out, const char *fmt, va_list args) {
+  while('\0'!=*fmt) {
+    if('%'!=*fmt) {
+      out.Put(*fmt++);                 // literal text
+      continue;
+    }
+    const char *start = fmt++;
+    char sp[32];                       // spec of a numeric conversion
+    uint8_t k = 0;
+    sp[k++] = '%';
+    bool left = false;
+    bool zero = false;
+    for(; ('-'==*fmt) || ('+'==*fmt) || (' '==*fmt) || ('#'==*fmt) || ('0'==*fmt); fmt++) {
+      left = left || ('-'==*fmt);
+      zero = zero || ('0'==*fmt);
+      if(k<6) {
+        sp[k++] = *fmt;
+      }
+    }
+    int width = 0;
+    if('*'==*fmt) {
+      width = va_arg(args,int);
+      if(width<0) {
+        left  = true;
+        width = -width;
+        sp[k++] = '-';
+      }
+      fmt++;
+    }
+    for(; ('0'<=*fmt) && (*fmt<='9'); fmt++) {
+      width = width*10 + (*fmt-'0');
+    }
+    width = (width<255) ? width : 255;
+    int prec = -1;
+    if('.'==*fmt) {
+      fmt++;
+      prec = 0;
+      if('*'==*fmt) {
+        prec = va_arg(args,int);
+        prec = (prec<0) ? -1 : prec;   // negative: no precision
+        fmt++;
+      }
+      for(; ('0'<=*fmt) && (*fmt<='9'); fmt++) {
+        prec = prec*10 + (*fmt-'0');
+      }
+    }
+    char len[2] = { 0, 0 };            // length modifier, e.g. "ll"
+    for(uint8_t nl=0; ('h'==*fmt) || ('l'==*fmt) || ('L'==*fmt) ||
+                      ('z'==*fmt) || ('j'==*fmt) || ('t'==*fmt); fmt++) {
+      if(nl<2) {
+        len[nl++] = *fmt;
+      }
+    }
+    char conv = *fmt;
+    if('\0'!=conv) {
+      fmt++;
+    }
+    switch(conv) {
+      case '%': {
+        out.Put('%');
+        break;
+      }
+      case 'c': {
+        char c = (char)va_arg(args,int);
+        fmtPad(out,' ',left ? 0 : width-1);
+        out.Put(c);
+        fmtPad(out,' ',left ? width-1 : 0);
+        break;
+      }
+      case 's': {
+        const char *s = va_arg(args,const char*);
+        s = (NULL!=s) ? s : "(null)";
+        int nb=0, nc=0;                // bytes and utf8 chars
+        for(; ('\0'!=s[nb]) && ((prec<0) || (nb<prec)); nb++) {
+          nc += (0x80!=(s[nb] & 0xc0)) ? 1 : 0;
+        }
+        fmtPad(out,' ',left ? 0 : width-nc);
+        for(int ib=0; ib<nb; ib++) {
+          out.Put(s[ib]);              // streamed, no copy
+        }
+        fmtPad(out,' ',left ? width-nc : 0);
+        break;
+      }
+      case 'n': {
+        (void)va_arg(args,void*);      // not supported, skipped
+        break;
+      }
+      case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+      case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+      case 'a': case 'A': case 'p': {
+        bool wide = (width >= fmtTMP); // padded here, else by snprintf
+        if(!wide && (width>0)) {
+          k = fmtNum(sp,k,width);
+        }
+        if(prec>=0) {
+          sp[k++] = '.';
+          k = fmtNum(sp,k,prec);       // digits behind fmtTMP are cut
+        }
+        for(uint8_t nl=0; (nl<2) && ('\0'!=len[nl]); nl++) {
+          sp[k++] = len[nl];
+        }
+        sp[k++] = conv;
+        sp[k]   = '\0';
+        char tmp[fmtTMP];
+        int m = 0;
+        bool sgn = ('d'==conv) || ('i'==conv);
+        if(('p'==conv)) {
+          m = snprintf(tmp,sizeof(tmp),sp,va_arg(args,void*));
+        } else if(('f'==conv) || ('F'==conv) || ('e'==conv) || ('E'==conv) ||
+                  ('g'==conv) || ('G'==conv) || ('a'==conv) || ('A'==conv)) {
+          if('L'==len[0]) {
+            m = snprintf(tmp,sizeof(tmp),sp,va_arg(args,long double));
+          } else {
+            m = snprintf(tmp,sizeof(tmp),sp,va_arg(args,double));
+          }
+        } else if(('l'==len[0]) && ('l'==len[1])) {
+          m = sgn ? snprintf(tmp,sizeof(tmp),sp,va_arg(args,long long))
+                  : snprintf(tmp,sizeof(tmp),sp,va_arg(args,unsigned long long));
+        } else if('l'==len[0]) {
+          m = sgn ? snprintf(tmp,sizeof(tmp),sp,va_arg(args,long))
+                  : snprintf(tmp,sizeof(tmp),sp,va_arg(args,unsigned long));
+        } else if('z'==len[0]) {
+          m = snprintf(tmp,sizeof(tmp),sp,va_arg(args,size_t));
+        } else if('j'==len[0]) {
+          m = sgn ? snprintf(tmp,sizeof(tmp),sp,va_arg(args,intmax_t))
+                  : snprintf(tmp,sizeof(tmp),sp,va_arg(args,uintmax_t));
+        } else if('t'==len[0]) {
+          m = snprintf(tmp,sizeof(tmp),sp,va_arg(args,ptrdiff_t));
+        } else {
+          m = sgn ? snprintf(tmp,sizeof(tmp),sp,va_arg(args,int))
+                  : snprintf(tmp,sizeof(tmp),sp,va_arg(args,unsigned int));
+        }
+        int len = (m<0) ? 0 : m;       // full length, for the padding
+        m = (len<(int)sizeof(tmp)) ? len : sizeof(tmp)-1;
+        int ic=0;
+        int np=0;                      // sign and 0x in front of the zeros
+        if((m>np) && (('-'==tmp[np]) || ('+'==tmp[np]) || (' '==tmp[np]))) {
+          np++;
+        }
+        if((m>np+1) && ('0'==tmp[np]) && (('x'==tmp[np+1]) || ('X'==tmp[np+1]))) {
+          np += 2;
+        }
+        // as printf: no zeros for an integer with precision, inf and nan
+        bool intg = ('d'==conv) || ('i'==conv) || ('u'==conv) || ('o'==conv) ||
+                    ('x'==conv) || ('X'==conv);
+        char c0 = (m>np) ? (tmp[np] | 0x20) : 'n'; // first digit, lower case
+        if(wide && !left && zero && !(intg && (prec>=0)) &&
+           ('i'!=c0) && ('n'!=c0)) {
+          for(; ic<np; ic++) {
+            out.Put(tmp[ic]);
+          }
+          fmtPad(out,'0',width-len);
+        } else {
+          fmtPad(out,' ',(wide && !left) ? width-len : 0);
+        }
+        for(; ic<m; ic++) {
+          out.Put(tmp[ic]);
+        }
+        fmtPad(out,' ',(wide && left) ? width-len : 0);
+        break;
+      }
+      default: {                       // unknown conversion, printed as is
+        for(; start<fmt; start++) {
+          out.Put(*start);
+        }
+        break;
+      }
+    }
+  }
+}
+
+#endif
+//__HDSP2112_FMT_H__
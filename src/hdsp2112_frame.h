@@ -0,0 +1,156 @@
+#ifndef __HDSP2112_FRAME_H__
+#define __HDSP2112_FRAME_H__
+
+// double buffered frame of the whole line. All drawing goes into the back
+// buffer, the displays are not touched. Present() writes the chars which
+// differ from the last presented frame by a single Present() of the
+// driver: position by position over all displays, equal chars of several
+// displays by a single cycle, so all displays change at the same time and
+// a line spanning several displays does not trail. The back buffer keeps
+// its content after Present(), i.e. a frame may be changed partially. The
+// frame works with every driver HDSP2112T<Bus>.
+//
+//   HdspFrame<HDSP2112> fr(d);
+//   fr.WriteText(0,"%-8s%8.2f",name,value);
+//   fr.Present();
+
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include "hdsp2112_fmt.h"
+#include "hdsp2112_utf8.h"
+
+template<class Drv>
+class HdspFrame : public Print {
+  private:
+    Drv *m_drv;                   // driver
+    uint8_t m_back[maxDSP*nPOS];  // back buffer, drawing
+    uint8_t m_front[maxDSP*nPOS]; // last presented frame
+    uint8_t m_max;                // number of chars of the line
+    uint8_t m_pos;                // cursor of print()
+    HdspUtf8 m_utf8;              // utf8 decoder, independent of the driver
+
+    // sink of hdspFormat(), decodes the utf8 text into the back buffer
+    class Sink {
+      public:
+        HdspFrame *m_f;   // frame
+        uint8_t m_pos;    // next position
+        size_t  m_n;      // number of chars
+        Sink(HdspFrame *f, uint8_t pos) : m_f(f), m_pos(pos), m_n(0) {
+          m_f->m_utf8.Clear();     // no sequence of print() pending
+        }
+        inline void Put(char c) {
+          uint8_t ch = m_f->m_utf8.Feed((uint8_t)c);
+          if(0!=ch) {
+            if(m_pos<m_f->m_max) {
+              m_f->m_back[m_pos++] = ch;
+            }
+            m_n++;
+          }
+        }
+    };
+
+  public:
+    // constructor, both buffers start with the chars of the shadow ram
+    // @param drv driver
+    HdspFrame(Drv &drv) {
+      m_drv = &drv;
+      m_max = drv.GetDisplays() * nPOS;
+      m_pos = 0;
+      m_utf8.SetFallback(drv.GetFallback());
+      for(uint8_t pos=0; pos<m_max; pos++) {
+        m_back[pos] = m_front[pos] = drv.GetChar(pos);
+      }
+    }
+
+    // fills the back buffer with blanks and sets the cursor to the start
+    inline void Clear(void) {
+      memset(m_back,' ',m_max);
+      m_pos = 0;
+    }
+
+    // writes a char into the back buffer
+    // @param pos position within the line
+    // @param ch  char of the hdsp2112
+    inline void WriteChar(uint8_t pos, uint8_t ch) {
+      if(pos<m_max) {
+        m_back[pos] = ch;
+      }
+    }
+
+    // gets a char of the back buffer
+    // @param pos position within the line
+    // @return char, '\0'=outside of the line
+    inline uint8_t GetChar(uint8_t pos) { return (pos<m_max) ? m_back[pos] : '\0'; }
+
+    // formats a text printf() like into the back buffer, chars behind the
+    // line are dropped
+    // @param pos    first position
+    // @param format printf style format string
+    // @param ...    variable parameters
+    // @return number of chars of the text
+    size_t WriteText(uint8_t pos, const char *format, ...) {
+      Sink out(this,pos);
+      va_list args;
+      va_start(args, format);
+      hdspFormat(out,format,args);
+      va_end(args);
+      m_pos = out.m_pos;
+      return out.m_n;
+    }
+
+    // sets the cursor of print()
+    // @param pos position within the line
+    inline void SetPos(uint8_t pos) { m_pos = (pos<m_max) ? pos : m_max; }
+
+    // @return cursor position of print()
+    inline uint8_t GetPos(void) { return m_pos; }
+
+    // writes the changed chars of the back buffer to the displays, all
+    // displays at once. Also flushes other pending changes of the driver.
+    void Present(void) {
+      bool af=m_drv->GetAutoFlush();
+      uint8_t cur=m_drv->GetPos();
+      m_drv->AutoFlush(0);             // collect all chars
+      for(uint8_t pos=0; pos<m_max; pos++) {
+        // also chars changed in between by other calls of the driver
+        if((m_back[pos]!=m_front[pos]) || (m_back[pos]!=m_drv->GetChar(pos))) {
+          m_drv->WriteChar(pos,m_back[pos]);
+        }
+      }
+      m_drv->SetPos(cur);              // keep the cursor of the driver
+      m_drv->Present();
+      memcpy(m_front,m_back,m_max);
+      if(af) {
+        m_drv->AutoFlush(1);           // nothing left to write
+      }
+    }
+
+    // virtual function of the Print class, writes a single char at the
+    // cursor into the back buffer
+    // @param character single character
+    // @return number of characters written
+    virtual size_t write(const uint8_t character) {
+      return write(&character,1);
+    }
+
+    // virtual function of the Print class, writes the chars at the cursor
+    // into the back buffer, chars behind the line are dropped
+    // @param buffer utf8 text
+    // @param size   number of bytes
+    // @return number of bytes
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+      for(size_t ic=0; ic<size; ic++) {
+        uint8_t ch = m_utf8.Feed(buffer[ic]);
+        if((0!=ch) && (m_pos<m_max)) {
+          m_back[m_pos++] = ch;
+        }
+      }
+      return size;
+    }
+
+    using Print::write;
+};
+
+#endif
+//__HDSP2112_FRAME_H__
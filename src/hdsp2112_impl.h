@@ -0,0 +1,1086 @@
+#ifndef __HDSP2112_IMPL_H__
+#define __HDSP2112_IMPL_H__
+
+// member functions of the HDSP2112T<Bus> template, included by hdsp2112.h
+
+// ------------------------------------------------------------------------
+// public members of class
+// ------------------------------------------------------------------------ 
+
+template<class Bus>
+HDSP2112T<Bus>::HDSP2112T(int8_t spi_cs, int8_t spi_clk, int8_t spi_mosi, int8_t spi_miso, uint8_t nDsp) 
+  : HDSP2112T(new Bus(spi_cs,spi_clk,spi_mosi,spi_miso),nDsp) {
+  m_own = true;                           // bus is freed by destructor
+}
+
+template<class Bus>
+HDSP2112T<Bus>::HDSP2112T(Bus *bus, uint8_t nDsp) 
+  : HDSP2112T(&bus,1,nDsp) {
+}
+
+template<class Bus>
+HDSP2112T<Bus>::HDSP2112T(Bus *const *bus, uint8_t nChn, uint8_t nDsp) {
+  m_nChn = (nChn<maxCHN) ? nChn : maxCHN; // limit to capacity
+  m_nDsp = (nDsp<m_nChn*nCHNDSP) ? nDsp : m_nChn*nCHNDSP;
+  m_maxPos = m_nDsp * nPOS;
+  m_ok = (m_nDsp>0);
+  for(uint8_t ic=0; ic<maxCHN; ic++) {
+    m_bus[ic] = (ic<m_nChn) ? bus[ic] : NULL; // bus backend of chain ic
+    m_ctrl[ic] = 0b11111111;              // U2.GPB[0..7] = res,fl,wr,rd,cs0..cs3
+    if(ic<m_nChn) {
+      m_ok = m_ok && m_bus[ic] && m_bus[ic]->Ok(); // m_ok==true if all valid
+    }
+  }
+  m_own = false;                          // bus is owned by caller
+  m_pos = 0;                              // set cursor to leftmost position
+  m_autoFlush = true;                     // write each call immediately
+  m_async = false;                        // write calls within caller
+  m_service = NULL;
+  m_txtLo = 0;                            // no chars to post
+  m_txtHi = 0;
+  m_nOverflow = 0;
+  m_tPost = 0;
+  m_pending = false;
+  m_maxLatency = 0;
+  m_busy = 0;                             // no self test
+  m_testRun = false;
+  m_testMask = 0;
+  m_testOK = 0;
+  m_testStart = 0;
+  m_testDur = 0;
+  m_testCb = NULL;
+  m_fadeMask = 0;                         // no fade
+  m_fadeCnt = 0;
+  m_fadeReq = 0;
+  m_fadeAck = 0;
+  m_scrubPeriod = 0;                      // no scrub
+  m_scrubLast = 0;
+  m_scrubHid = 0;
+  m_scrubRuns = 0;
+  m_scrubFixed = 0;
+#ifdef ESP32
+  m_fadeTimer = NULL;
+  m_task = NULL;                          // no render task
+  m_period = 0;
+#endif
+
+  m_cwr = 0b00000000;     // initial hdsp2112 code-word-register
+        //  |||||\_\__d2..d0 brightness = 000 = 100%
+        //  ||||\_____d3     flash = 0 OFF
+        //  |||\______d4     blink = 0 OFF
+        //  ||\_______d5     don't care
+        //  |\________d6     selftest = 0 OFF
+        //  \_________d7     clear = 0 normal operation 
+
+  memset(m_chr,' ',maxCHR);               // chars of the caller, blank
+  for(uint8_t hid=0; hid<maxDSP; hid++) {
+    ResetShadow(hid);                     // state after the first Reset()
+    m_shd[hid].vUdc = 0;                  // udc-ram content unknown
+    m_shd[hid].dUdc = 0;
+    memset(m_shd[hid].dRow,0,UDC_nch);
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::Begin(void) {
+  if(m_ok) {
+    for(uint8_t ic=0; ic<m_nChn; ic++) {
+      m_bus[ic]->Begin();          // e.g. SPI and the two mcp23s17
+    }
+    Reset();                       // reset all displays now
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::Reset(void) {
+  HDSP_PROF(prfReset);
+  if(m_ok) {
+    m_cwr = (m_cwr & ~cwrBRIGHT) | 4; // default brightness
+    memset(m_chr,' ',m_maxPos);  // reset blanks all chars
+    if(posting()) {
+      post(cmdRESET,0,m_fadeReq,m_cwr);
+      kick();
+    } else {
+      resetDisplays(m_cwr,m_fadeReq);
+    }
+    SetPos(0);                 // set cursor to leftmost position
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::resetDisplays(uint8_t cwr, uint8_t fade) {
+  for(uint8_t ic=0; ic<m_nChn; ic++) {
+    m_ctrl[ic] &= ~gpbRES & ~gpbCS;
+    setCtrl(ic);               // activate reset
+  }
+  sync();                      // delays are counted from the bus
+  hdspDelayUs(10);             // reset pulse (req. =300ns) 
+  for(uint8_t ic=0; ic<m_nChn; ic++) {
+    m_ctrl[ic] |= gpbRES | gpbCS;
+    setCtrl(ic);               // release reset
+  }
+  sync();
+  hdspDelayMs(1);              // hold (req. =110µs) 
+  if(m_busy) {
+    m_busy = 0;                // reset aborts a running self test
+    m_testOK = 0;
+    m_testRun = false;
+  }
+  m_fadeMask = 0;              // reset aborts all fades so far
+  m_fadeCnt  = fade;
+  m_fadeAck  = fade;
+  for(uint8_t hid=0; hid<m_nDsp; hid++) {
+    ResetShadow(hid);          // chars=blank, flash=0, cwr=0 
+  }
+  putCwr(0xff,cwr,dspALL);     // e.g. default brightness
+  Flush();                     // displays are in a defined state now
+}
+
+// The clear bit is written with the control-word of each display, equal
+// control-words at once. Displays in self test get blanks and cleared
+// flash bits in the shadow ram, which are written after the test.
+template<class Bus>
+void HDSP2112T<Bus>::clearDisplays(void) {
+  uint16_t all=0;              // displays cleared by cwrCLEAR
+  for(uint8_t hid=0; hid<m_nDsp; hid++) {
+    if(m_busy & (1u<<hid)) {
+      for(uint8_t ic=0; ic<nPOS; ic++) {
+        putChr(hid*nPOS+ic,' ');
+      }
+      putFlash(0,hid*nPOS,nPOS);
+    } else {
+      all |= 1u<<hid;
+    }
+  }
+  uint16_t todo=all;
+  while(todo) {                // one write per distinct control-word
+    uint8_t cwr = m_shd[__builtin_ctz(todo)].cwr;
+    uint16_t grp = 0;
+    for(uint8_t hid=0; hid<m_nDsp; hid++) {
+      if((todo & (1u<<hid)) && (m_shd[hid].cwr==cwr)) {
+        grp |= 1u<<hid;
+      }
+    }
+    WrGroup(adrCWR,cwr|cwrCLEAR,grp);
+    todo &= ~grp;
+  }
+  if(all) {
+    sync();                    // e.g. queued transactions of a DMA bus
+    hdspDelayUs(usCLEAR);      // clear (req. =110µs)
+  }
+  for(uint8_t hid=0; hid<m_nDsp; hid++) {
+    if(all & (1u<<hid)) {
+      HdspShadow &s = m_shd[hid];
+      memset(s.chr,' ',nPOS);  // character-RAM is blank
+      s.flash  = 0;            // flash-RAM is 0
+      s.dChr   = 0;
+      s.dFlash = 0;
+      s.dCwr   = true;         // control-word without cwrCLEAR
+    }
+  }
+  flushCwr();
+  commit();
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::ResetShadow(uint8_t hid) {
+  HdspShadow &s = m_shd[hid];
+  memset(s.chr,' ',nPOS);      // character-RAM is loaded with blanks
+  s.flash  = 0;                // flash-RAM is loaded with 0
+  s.cwr    = 0;                // control-word-register is loaded with 0
+  s.dChr   = 0;
+  s.dFlash = 0;
+  s.dCwr   = false;
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::SetCwr(uint8_t bits, uint8_t cwr, uint16_t dsp) {
+  HDSP_PROF(prfSetCwr);
+  if(posting()) {
+    post(cmdCWR,bits,cwr,dsp);
+  } else {
+    stopFade(bits,dsp);
+    putCwr(bits,cwr,dsp);
+  }
+  if(m_autoFlush) {
+    Flush();
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::putCwr(uint8_t bits, uint8_t cwr, uint16_t dsp) {
+  for(uint8_t hid=0; hid<m_nDsp; hid++) {
+    HdspShadow &s = m_shd[hid];
+    uint8_t v = (s.cwr & ~bits) | (cwr & bits);
+    if((dsp & (1u<<hid)) && (s.cwr != v)) {
+      s.cwr  = v;
+      s.dCwr = true;
+    }
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::Service(void) {
+  HDSP_PROF(prfService);
+  if(m_ok) {
+    HdspCmd cmd;
+    m_service = hdspContext(); // calls access the bus directly now
+    uint16_t n = m_queue.Size(); // limit to calls posted so far
+    for(; (n>0) && m_queue.Pop(cmd); n--) {
+      if(!m_pending) {
+        m_pending = true;      // oldest call not yet written
+        m_tPost = cmd.t;
+      }
+      switch(cmd.op) {
+        case cmdFLUSH:
+        case cmdPRESENT: { 
+          if(cmdPRESENT==cmd.op) {
+            Present();
+          } else {
+            Flush(); 
+          }
+          uint32_t lat = micros() - m_tPost;
+          m_maxLatency = (lat>m_maxLatency) ? lat : m_maxLatency;
+          m_pending = false;
+          break; 
+        }
+        case cmdTEXT:  { putText(cmd.a,cmd.b);        break; }
+        case cmdCWR:   { stopFade(cmd.a,cmd.v); putCwr(cmd.a,cmd.b,cmd.v); break; }
+        case cmdFLB:   { putFlash(cmd.v,cmd.a,cmd.b);  break; }
+        case cmdUDC:   { putUdc(cmd.p,cmd.a);          break; }
+        case cmdFONT:  { loadFont(cmd.p,cmd.a,cmd.v,cmd.b); break; }
+        case cmdRESET: { resetDisplays(cmd.v,cmd.b);   break; }
+        case cmdCLEAR: { clearDisplays();              break; }
+        case cmdTEST:  { startTest(cmd.a|(cmd.b<<8),cmd.v); break; }
+        case cmdFADE:  { startFade(cmd.a,cmd.v>>16,cmd.v&0xffff,cmd.b); break; }
+      }
+    }
+    if(m_busy) {
+      pollTest();              // self test finished?
+    }
+    if(m_fadeMask) {
+      serviceFade();           // next level of the fades due?
+    }
+    if(m_scrubPeriod) {
+      serviceScrub();          // next read back due?
+    }
+    m_service = NULL;
+  }
+}
+
+#ifdef ESP32
+template<class Bus>
+bool HDSP2112T<Bus>::StartRenderTask(uint8_t core, uint8_t prio, uint32_t period_ms) {
+  if(m_ok && (NULL==m_task)) {
+    m_period = (period_ms>0) ? period_ms : 1;
+    m_async  = true;           // post all calls from now on
+    if(pdPASS!=xTaskCreatePinnedToCore(renderTask,"hdsp2112",4096,this,prio,&m_task,core)) {
+      m_task  = NULL;
+      m_async = false;
+    } else if(NULL==m_fadeTimer) {
+      esp_timer_create_args_t ta = {};
+      ta.callback = fadeTimer; // wakes the render task for fades
+      ta.arg      = this;
+      ta.name     = "hdsp2112";
+      if(ESP_OK!=esp_timer_create(&ta,&m_fadeTimer)) {
+        m_fadeTimer = NULL;    // fades advance with the period only
+      }
+    }
+  }
+  return (NULL!=m_task);
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::renderTask(void *arg) {
+  HDSP2112T<Bus> *d = (HDSP2112T<Bus>*)arg;
+  for(;;) {
+    ulTaskNotifyTake(pdTRUE,pdMS_TO_TICKS(d->m_period)); // flush or period
+    d->Service();
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::fadeTimer(void *arg) {
+  ((HDSP2112T<Bus>*)arg)->kick();
+}
+#endif
+
+template<class Bus>
+void HDSP2112T<Bus>::Fade(uint8_t level, uint16_t ms, uint16_t dsp) {
+  HDSP_PROF(prfSetCwr);
+  if(m_ok) {
+    uint8_t fade = m_fadeReq + 1; // Fading() until finished by Service()
+    if(posting()) {
+      if(post(cmdFADE,level,fade,dsp|((uint32_t)ms<<16))) {
+        m_fadeReq = fade;      // a lost fade is not waited for
+      }
+      kick();
+    } else {
+      m_fadeReq = fade;
+      startFade(level,ms,dsp,fade);
+    }
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::startFade(uint8_t level, uint16_t ms, uint16_t dsp, uint8_t fade) {
+  uint32_t now=micros();
+  for(uint8_t hid=0; hid<m_nDsp; hid++) {
+    if(dsp & (1u<<hid)) {
+      HdspFade &f = m_fade[hid];
+      f.t0   = now;
+      f.dur  = ms * 1000ul;
+      f.from = m_shd[hid].cwr & cwrBRIGHT;
+      f.to   = level & cwrBRIGHT;
+      m_fadeMask |= 1u<<hid;   // replaces a running fade
+    }
+  }
+  m_fadeCnt = fade;
+  serviceFade();               // e.g. at once, if ms=0
+}
+
+// The level is the one with the nearest L*, i.e. it changes when L* 
+// crosses the middle between two levels. The time of the next crossing
+// follows from the linear ramp of L*.
+template<class Bus>
+uint32_t HDSP2112T<Bus>::stepFade(uint32_t now) {
+  uint16_t grp[8] = { 0 };     // displays per new level
+  uint32_t wait = 0xffffffff;
+  for(uint8_t hid=0; hid<m_nDsp; hid++) {
+    if(!(m_fadeMask & (1u<<hid))) {
+      continue;
+    }
+    HdspFade &f = m_fade[hid];
+    uint32_t e = now - f.t0;   // elapsed time [µs]
+    uint8_t lvl = f.to;
+    if(e >= f.dur) {
+      m_fadeMask &= ~(1u<<hid);// finished
+    } else {
+      int32_t l0 = fdL[f.from];
+      int32_t dl = fdL[f.to] - l0;
+      int32_t l  = l0 + (int32_t)((int64_t)dl * e / f.dur);
+      for(uint8_t il=0; il<8; il++) {
+        int32_t d0 = fdL[il] - l;
+        int32_t d1 = fdL[lvl] - l;
+        if(d0*d0 < d1*d1) {
+          lvl = il;            // nearest level
+        }
+      }
+      uint32_t w = f.dur - e;  // target reached, wait for the end
+      if(lvl!=f.to) {
+        uint8_t nx = (f.to>lvl) ? lvl+1 : lvl-1;
+        int32_t mid = (fdL[lvl] + fdL[nx]) / 2;
+        uint32_t tn = (uint32_t)((int64_t)f.dur * (mid-l0) / dl) + 1;
+        w = (tn>e) ? tn-e : 1;
+      }
+      wait = (w<wait) ? w : wait;
+    }
+    grp[lvl] |= 1u<<hid;
+  }
+  for(uint8_t il=0; il<8; il++) {
+    if(grp[il]) {
+      putCwr(cwrBRIGHT,il,grp[il]);
+    }
+  }
+  if(0==m_fadeMask) {
+    m_fadeAck = m_fadeCnt;     // all fades finished
+  }
+  return wait;
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::serviceFade(void) {
+  uint32_t wait = stepFade(micros());
+  flushCwr();                  // all displays with a new level at once
+  commit();
+#ifdef ESP32
+  if((NULL!=m_fadeTimer) && m_fadeMask) {
+    esp_timer_stop(m_fadeTimer);
+    esp_timer_start_once(m_fadeTimer,wait);
+  }
+#else
+  (void)wait;
+#endif
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::Flush(void) {
+  HDSP_PROF(prfFlush);
+  if(posting()) {
+    postText();                // chars changed by the caller
+    post(cmdFLUSH,0,0);        // render task writes the displays
+    kick();
+  } else if(m_ok) {
+    flushUdc();                // user defined chars
+    flushCwr();                // control-words
+    flushFlash();              // flash bits
+    flushChr();                // chars
+    commit();                  // end of the frame, e.g. start of a DMA queue
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::Present(void) {
+  HDSP_PROF(prfFlush);
+  if(posting()) {
+    postText();                // chars changed by the caller
+    post(cmdPRESENT,0,0);      // render task writes the displays
+    kick();
+  } else if(m_ok) {
+    flushUdc();                // user defined chars
+    flushCwr();                // control-words
+    flushFlash();              // flash bits
+    flushChrPos();             // chars, all displays at once
+    commit();
+  }
+}
+
+// FL selects the flash-RAM like an address line, it is set by a separate
+// U2 transaction before the first and after the last cycle of a chain, 
+// which lasts longer than the required setup and hold times.
+template<class Bus>
+void HDSP2112T<Bus>::flushFlash(void) {
+  HdspWr wr[maxCHN];
+  uint8_t fl=0;                // chains with FL=low
+  uint8_t n;
+  do {
+    n=0;
+    for(uint8_t ic=0; ic<m_nChn; ic++) { // next dirty bit of each chain
+      uint8_t last=(ic+1)*nCHNDSP;
+      for(uint8_t hid=ic*nCHNDSP; (hid<m_nDsp) && (hid<last); hid++) {
+        HdspShadow &s = m_shd[hid];
+        if(s.dFlash && !(m_busy & (1u<<hid))) {
+          uint8_t pos = __builtin_ctz(s.dFlash);
+          s.dFlash &= ~(1u<<pos);
+          if(!(fl & (1u<<ic))) {
+            setFL(0,ic);       // FL=low, flash-RAM of all displays of ic
+            fl |= 1u<<ic;
+          }
+          // burst: cs stays low until the last dirty bit of the display
+          wr[n++] = { hid, pos, (uint8_t)((s.flash>>pos) & 1u), 0!=s.dFlash };
+          break;
+        }
+      }
+    }
+    if(n>0) {
+      WrCycles(wr,n);
+    }
+  } while(n>0);
+  for(uint8_t ic=0; ic<m_nChn; ic++) {
+    if(fl & (1u<<ic)) {
+      setFL(1,ic);             // FL=high
+    }
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::flushChr(void) {
+  HdspWr wr[maxCHN];
+  uint8_t n;
+  flushChrPos(2);              // shared chars, e.g. blanks after clear()
+  do {
+    n=0;
+    for(uint8_t ic=0; ic<m_nChn; ic++) { // next dirty char of each chain
+      uint8_t last=(ic+1)*nCHNDSP;
+      for(uint8_t hid=ic*nCHNDSP; (hid<m_nDsp) && (hid<last); hid++) {
+        HdspShadow &s = m_shd[hid];
+        if(s.dChr && !(m_busy & (1u<<hid))) {
+          uint8_t pos = __builtin_ctz(s.dChr);
+          s.dChr &= ~(1u<<pos);
+          // burst: cs stays low until the last dirty char of the display
+          wr[n++] = { hid, (uint8_t)(adrCHR|pos), s.chr[pos], 0!=s.dChr };
+          break;
+        }
+      }
+    }
+    if(n>0) {
+      WrCycles(wr,n);
+    }
+  } while(n>0);
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::flushChrPos(uint8_t min) {
+  for(uint8_t pos=0; pos<nPOS; pos++) {
+    uint16_t todo=0;           // displays with a dirty char at pos
+    for(uint8_t hid=0; hid<m_nDsp; hid++) {
+      if((m_shd[hid].dChr & (1u<<pos)) && !(m_busy & (1u<<hid))) {
+        todo |= 1u<<hid;       // busy: self test, no access
+      }
+    }
+    while(todo) {              // one write per distinct char
+      uint8_t ch = m_shd[__builtin_ctz(todo)].chr[pos];
+      uint16_t grp = 0;
+      for(uint8_t hid=0; hid<m_nDsp; hid++) {
+        if((todo & (1u<<hid)) && (m_shd[hid].chr[pos]==ch)) {
+          grp |= 1u<<hid;
+        }
+      }
+      todo &= ~grp;
+      if(__builtin_popcount(grp) >= min) {
+        for(uint8_t hid=0; hid<m_nDsp; hid++) {
+          if(grp & (1u<<hid)) {
+            m_shd[hid].dChr &= ~(1u<<pos);
+          }
+        }
+        WrGroup(adrCHR|pos,ch,grp);
+      }
+    }
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::flushCwr(void) {
+  uint16_t todo=0;             // dirty control-words
+  for(uint8_t hid=0; hid<m_nDsp; hid++) {
+    if(m_shd[hid].dCwr && !(m_busy & (1u<<hid))) {
+      todo |= 1u<<hid;         // busy: self test, no access
+    }
+  }
+  while(todo) {                // one write per distinct control-word
+    uint8_t cwr = m_shd[__builtin_ctz(todo)].cwr;
+    uint16_t grp = 0;
+    for(uint8_t hid=0; hid<m_nDsp; hid++) {
+      if((todo & (1u<<hid)) && (m_shd[hid].cwr==cwr)) {
+        grp |= 1u<<hid;
+        m_shd[hid].dCwr = false;
+      }
+    }
+    WrGroup(adrCWR,cwr,grp);
+    todo &= ~grp;
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::flushUdc(void) {
+  for(uint8_t ic=0; ic<UDC_nch; ic++) {
+    uint16_t msk = 1u<<ic;
+    uint8_t rows = 0;          // union of the dirty rows
+    bool bc=(0==m_busy);       // broadcast, if all dirty and equal
+    for(uint8_t hid=0; hid<m_nDsp; hid++) {
+      bc = bc && (m_shd[hid].dUdc & msk) &&
+           (0==memcmp(m_shd[hid].udc[ic],m_shd[0].udc[ic],UDC_rows));
+      rows |= m_shd[hid].dRow[ic];
+    }
+    if(bc) {
+      WrUdChar(m_shd[0].udc[ic],ic,rows);
+    }
+    for(uint8_t hid=0; hid<m_nDsp; hid++) {
+      HdspShadow &s = m_shd[hid];
+      if(m_busy & (1u<<hid)) {
+        continue;              // self test, no access
+      }
+      if((s.dUdc & msk) && !bc) {
+        uint8_t dr = s.dRow[ic];
+        WrData(adrUDA,ic,hid,true); // UDC address-register = udc_char-index
+        for(uint8_t jc=0; jc<UDC_rows; jc++) { 
+          if(dr & (1u<<jc)) {  // unchanged rows are skipped
+            dr &= ~(1u<<jc);
+            WrData(adrUDR+jc,s.udc[ic][jc],hid,0!=dr);
+          }
+        }
+      }
+      s.dUdc &= ~msk;
+      s.dRow[ic] = 0;
+    }
+  }
+}
+
+
+// The datasheet allows to tie WR and CS together (write cycle timing, 
+// note 2), so both edges are switched by the same U2 write and the whole
+// pulse is sent within a single U2 transaction (PulseCtrl). The pulse 
+// lasts 16 SPI clocks, longer than the required wr pulse (100ns), 
+// therefore no additional delay is needed.
+template<class Bus>
+void HDSP2112T<Bus>::WrData(uint8_t addr, uint8_t data, uint8_t hid, bool hold) {
+  HdspWr wr = { hid, addr, data, hold };
+  WrCycles(&wr,1);
+}
+
+// With several chains the SPI transactions of one chain fill the wait 
+// times of the others: address and data of all chains are set before the 
+// first wr pulse, the wr pulse of one chain lasts while the next one is 
+// selected.
+template<class Bus>
+void HDSP2112T<Bus>::WrCycles(const HdspWr *wr, uint8_t n) {
+  HDSP_PROF(prfWrData);
+  if(m_ok) {
+    for(uint8_t iw=0; iw<n; iw++) {
+      setAddrData(wr[iw].addr,wr[iw].data,chainOf(wr[iw].hid)); 
+    }
+    for(uint8_t iw=0; iw<n; iw++) {
+      uint8_t ic=chainOf(wr[iw].hid);
+      uint8_t cs=csOf(wr[iw].hid);
+      uint8_t low=m_ctrl[ic] & ~(cs|gpbWR); // cs=low, wr=low (select hid)
+      m_ctrl[ic] = wr[iw].hold ? low|gpbWR : low|cs|gpbWR;
+      m_bus[ic]->PulseCtrl(low,m_ctrl[ic]); // wr=high, cs=high unless hold
+    }
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::WrData(uint8_t addr, uint8_t data) {
+  HDSP_PROF(prfWrData);
+  if(m_ok) {
+    for(uint8_t ic=0; ic<m_nChn; ic++) {
+      setAddrData(addr,data,ic); // set address and data bus
+    }
+    for(uint8_t ic=0; ic<m_nChn; ic++) {
+      uint8_t low=m_ctrl[ic] & ~(gpbCS|gpbWR); // cs=low, wr=low (all)
+      m_ctrl[ic] |= gpbCS|gpbWR;
+      m_bus[ic]->PulseCtrl(low,m_ctrl[ic]);   // cs=high, wr=high
+    }
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::WrGroup(uint8_t addr, uint8_t data, uint16_t dsp) {
+  HDSP_PROF(prfWrData);
+  if(m_ok) {
+    uint8_t cs[maxCHN];
+    for(uint8_t ic=0; ic<m_nChn; ic++) {
+      cs[ic] = 0;              // cs of the group within chain ic
+      uint8_t last=(ic+1)*nCHNDSP;
+      for(uint8_t hid=ic*nCHNDSP; (hid<m_nDsp) && (hid<last); hid++) {
+        cs[ic] |= (dsp & (1u<<hid)) ? csOf(hid) : 0u;
+      }
+      if(cs[ic]) {
+        setAddrData(addr,data,ic); // set address and data bus
+      }
+    }
+    for(uint8_t ic=0; ic<m_nChn; ic++) {
+      if(cs[ic]) {
+        uint8_t low=m_ctrl[ic] & ~(cs[ic]|gpbWR); // cs=low, wr=low (group)
+        m_ctrl[ic] = low|cs[ic]|gpbWR;
+        m_bus[ic]->PulseCtrl(low,m_ctrl[ic]);      // cs=high, wr=high
+      }
+    }
+  }
+}
+
+template<class Bus>
+uint8_t HDSP2112T<Bus>::RdData(uint8_t addr, uint8_t hid) {
+  uint8_t data=0;
+  rdRun(hid,&addr,1,&data);
+  return data;
+}
+
+// The address is set while cs is low and rd is high, the display latches
+// it at the falling edge of rd. Each GetData() lasts longer than the data
+// setup time (req.=75ns), so no delay is needed within the run.
+template<class Bus>
+void HDSP2112T<Bus>::rdRun(uint8_t hid, const uint8_t *addr, uint8_t n, uint8_t *data) {
+  HDSP_PROF(prfRdData);
+  if(m_ok) {
+    uint8_t ic=chainOf(hid);   // chain of display hid
+    DataDirection(INPUT,ic);   // set U1.Port-B to readmode, once per run
+    m_bus[ic]->Sync();         // delays are counted from the bus
+    hdspDelayUs(1);            // wait a little
+    setCS(0,hid);              // cs=low for the whole run
+    for(uint8_t ir=0; ir<n; ir++) {
+      setAddr(addr[ir],ic);    // set address
+      setRD(0,ic);             // rd=low
+      data[ir]=m_bus[ic]->GetData(); // read data bus d[0..7]
+      setRD(1,ic);             // rd=high
+    }
+    setCS(1,hid);              // cs=high
+    DataDirection(OUTPUT,ic);  // set U1.Port-B to writemode
+    m_bus[ic]->Sync();
+    hdspDelayUs(1);            // wait a little
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::serviceScrub(void) {
+  uint32_t now = millis();
+  if((now - m_scrubLast) < m_scrubPeriod) {
+    return;
+  }
+  if(m_busy) {
+    return;                    // self test running
+  }
+  for(uint8_t hid=0; hid<m_nDsp; hid++) {
+    HdspShadow &s = m_shd[hid];
+    if(s.dChr || s.dFlash || s.dUdc || s.dCwr) {
+      return;                  // changes not yet flushed, scrub later
+    }
+  }
+  m_scrubLast = now;
+  uint8_t hid = (m_scrubHid<m_nDsp) ? m_scrubHid : 0;
+  m_scrubHid = hid+1;          // next display in the next run
+  uint8_t addr[nPOS+1];
+  uint8_t data[nPOS+1];
+  for(uint8_t ic=0; ic<nPOS; ic++) {
+    addr[ic] = adrCHR + ic;    // char-RAM
+  }
+  addr[nPOS] = adrCWR;         // control-word
+  rdRun(hid,addr,nPOS+1,data);
+  m_scrubRuns++;
+  HdspShadow &s = m_shd[hid];
+  for(uint8_t ic=0; ic<nPOS; ic++) {
+    if(data[ic] != s.chr[ic]) {
+      s.dChr |= (1u<<ic);      // rewrite char
+      m_scrubFixed++;
+    }
+  }
+  if((data[nPOS] & ~cwrTSTOK) != (s.cwr & ~cwrTSTOK)) {
+    s.dCwr = true;             // rewrite control-word
+    m_scrubFixed++;
+  }
+  if(s.dChr || s.dCwr) {
+    Flush();                   // only the cells which differ
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::SetFlashBits(uint32_t fb, uint8_t pos, uint8_t n) {
+  HDSP_PROF(prfSetFlash);
+  if(m_ok && (n>0) && (n<=32)) {
+    if(posting()) {
+      post(cmdFLB,pos,n,fb);
+    } else {
+      putFlash(fb,pos,n);
+    }
+    if(m_autoFlush) {
+      Flush();
+    }
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::SetFlashBits(const uint8_t *fb, uint8_t n) {
+  bool af=m_autoFlush;
+  m_autoFlush=false;           // single flush for all bytes
+  n = (n<maxDSP) ? n : maxDSP; // one byte per display
+  for(uint8_t ib=0; ib<n; ib+=4) {
+    uint32_t v=0;
+    for(uint8_t jb=0; jb<4; jb++) {
+      v = (v<<8) | ((ib+jb<n) ? fb[ib+jb] : 0u);
+    }
+    uint8_t nb = (n-ib<4) ? n-ib : 4;
+    SetFlashBits(v,ib*8,nb*8);
+  }
+  m_autoFlush=af;
+  if(m_autoFlush) {
+    Flush();
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::putFlash(uint32_t fb, uint8_t pos, uint8_t n) {
+  for(uint8_t ic=0; (ic<n) && (pos+ic<m_maxPos); ic++) { 
+    HdspShadow &s = m_shd[(pos+ic) / nPOS]; // select display
+    uint8_t bit  = 1u<<((pos+ic) % nPOS);   // select bit address
+    uint32_t msk = 0x80000000>>ic;          // select bit position
+    uint8_t data = (msk==(msk & fb))? bit : 0u; 
+    if((s.flash & bit) != data) {
+      s.flash   = (s.flash & ~bit) | data;
+      s.dFlash |= bit;                      // mark flash bit dirty
+    }
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::SetUdcFont(const uint8_t *font, uint8_t nChars){
+  HDSP_PROF(prfSetUdcFont);
+  if(m_ok) {
+    m_cwr = (m_cwr & ~cwrBRIGHT) | 4; // default brightness, see Reset()
+    memset(m_chr,' ',m_maxPos);  // reset blanks all chars
+    if(posting()) {
+      post(cmdFONT,nChars,m_fadeReq,m_cwr,font);
+      kick();
+    } else {
+      loadFont(font,nChars,m_cwr,m_fadeReq);
+    }
+    SetPos(0);
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::loadFont(const uint8_t *font, uint8_t nChars, uint8_t cwr, uint8_t fade){
+  for(uint8_t ic=0; ic<nChars; ic++) {
+    uint32_t offset = ic * UDC_rows;
+    putUdc(font + offset, ic);
+  }
+  Flush();
+  WrUdChar(font,0);            // workaround: first char needs to be set twice
+  resetDisplays(cwr,fade);     // the display need a reset() here 
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::SetUdChar(const uint8_t *map, const uint8_t idx){
+  HDSP_PROF(prfSetUdChar);
+  if(m_ok && (idx<UDC_nch)) {
+    if(posting()) {
+      post(cmdUDC,idx,0,0,map);
+    } else {
+      putUdc(map,idx);
+    }
+    if(m_autoFlush) {
+      Flush();
+    }
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::putUdc(const uint8_t *map, const uint8_t idx){
+  uint16_t msk = 1u<<idx;
+  for(uint8_t hid=0; hid<m_nDsp; hid++) {
+    HdspShadow &s = m_shd[hid];
+    uint8_t rows = 0;          // changed rows, all if the char is unknown
+    for(uint8_t jc=0; jc<UDC_rows; jc++) {
+      if(!(s.vUdc & msk) || (s.udc[idx][jc]!=map[jc])) {
+        rows |= 1u<<jc;
+      }
+    }
+    if(rows) {
+      memcpy(s.udc[idx],map,UDC_rows);
+      s.vUdc |= msk;           // udc char is known now 
+      s.dUdc |= msk;           // mark udc char dirty 
+      s.dRow[idx] |= rows;     // only these rows are written
+    }
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::WrUdChar(const uint8_t *map, const uint8_t idx, uint8_t rows){
+  if(m_ok) {
+    WrData(adrUDA,idx);        // UDC address-register = current udc_char-index
+    for(uint8_t jc=0; jc<UDC_rows; jc++) { 
+      if(rows & (1u<<jc)) {
+        uint8_t addr=adrUDR+jc;// UDC ram address + row-address
+        uint8_t data=map[jc];
+        WrData(addr,data);     // write row to UDC ram
+      }
+    }
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::WriteChar(char ch) {
+  HDSP_PROF(prfWriteChar);
+  if(m_ok) {
+    if(m_pos < m_maxPos) {        // check if valid position 
+      storeChr(m_pos,ch);         // store char in shadow ram (or m_chr)
+      m_pos++;                    // increment cursor
+      if(m_autoFlush) {
+        Flush();                  // print changed chars
+      }
+    }
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::putChr(uint8_t pos, uint8_t ch) {
+  HdspShadow &s = m_shd[pos / nPOS]; // find display identifier
+  uint8_t ic = pos % nPOS;      // find position within display
+  if(s.chr[ic] != ch) {
+    s.chr[ic] = ch;             // store char in shadow ram
+    s.dChr |= (1u<<ic);         // mark position dirty
+  }
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::WriteChar(const uint8_t pos, char ch) {
+  if(m_ok) {
+    m_pos = pos;    // store position to given pos
+    WriteChar(ch);  // write char
+  }
+}
+
+template<class Bus>
+size_t HDSP2112T<Bus>::WriteText(const uint8_t pos, const char *format, ...) {
+  HDSP_PROF(prfWriteText);
+  if(m_ok) {
+    bool af=m_autoFlush;
+    m_autoFlush=false;           // collect all chars, single flush
+    SetPos(pos);
+    uint8_t start=m_pos;         // pos behind the line is limited
+    m_utf8.Clear();              // the text starts with a new char
+    WinSink out(this,start,m_maxPos);
+    va_list args;
+    va_start(args, format);
+    hdspFormat(out,format,args); // limited to all chars
+    va_end(args);
+    m_pos=out.m_pos;
+    m_autoFlush=af;
+    if(m_autoFlush) {
+      Flush();
+    }
+    return out.m_pos-start; 
+  }
+  return 0;
+}
+
+template<class Bus>
+size_t HDSP2112T<Bus>::WriteField(uint8_t pos, uint8_t width, uint8_t align, const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  size_t n=WriteFieldV(pos,width,align,format,args);
+  va_end(args);
+  return n;
+}
+
+template<class Bus>
+size_t HDSP2112T<Bus>::WriteFieldV(uint8_t pos, uint8_t width, uint8_t align, const char *format, va_list args) {
+  HDSP_PROF(prfWriteText);
+  if(m_ok && (pos<m_maxPos)) {
+    uint8_t end = ((0==width) || (width>m_maxPos-pos)) ? m_maxPos : pos+width;
+    width = end-pos;
+    uint8_t off=0;               // blanks in front of the text
+    if(alLEFT!=align) {
+      HdspCount cnt(m_utf8.GetFallback());
+      va_list cp;
+      va_copy(cp,args);
+      hdspFormat(cnt,format,cp); // 1st pass: length of the text only
+      va_end(cp);
+      if(cnt.m_n<width) {
+        off = (alRIGHT==align) ? width-cnt.m_n : (width-cnt.m_n)/2;
+      }
+    }
+    bool af=m_autoFlush;
+    m_autoFlush=false;           // collect all chars, single flush
+    for(uint8_t ic=pos; ic<pos+off; ic++) {
+      storeChr(ic,' ');
+    }
+    m_utf8.Clear();              // the text starts with a new char
+    WinSink out(this,pos+off,end);
+    hdspFormat(out,format,args);
+    for(uint8_t ic=out.m_pos; ic<end; ic++) {
+      storeChr(ic,' ');          // blanks behind the text
+    }
+    m_pos=out.m_pos;
+    m_autoFlush=af;
+    if(m_autoFlush) {
+      Flush();
+    }
+    return out.m_pos-pos-off;
+  }
+  return 0;
+}
+
+template<class Bus>
+uint8_t HDSP2112T<Bus>::Selftest(uint8_t hid) {
+  if(m_ok && (hid<m_nDsp) && StartSelftest(1u<<hid)) {
+    while(SelftestBusy()) {
+      hdspDelayMs(10);
+      if(!rendering()) {
+        Service();                    // else done by the render task
+      }
+    }
+    return (m_testOK>>hid) & 1u;      // cwrTSTOK=1 --> OK
+  } 
+  return 0;
+}
+
+template<class Bus>
+bool HDSP2112T<Bus>::StartSelftest(uint16_t mask, HdspTestCb cb, uint32_t duration) {
+  mask &= (uint16_t)((1ul<<m_nDsp)-1);// existing displays only
+  if(m_ok && !m_testRun && mask) {
+    m_testRun = true;
+    m_testCb  = cb;
+    if(posting()) {
+      post(cmdTEST,mask&0xff,mask>>8,duration);
+      kick();
+    } else {
+      startTest(mask,duration);
+    }
+    return true;
+  }
+  return false;
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::startTest(uint16_t mask, uint32_t duration) {
+  Flush();                            // write pending changes first
+  m_testMask  = mask;
+  m_testOK    = 0;
+  m_testStart = millis();
+  m_testDur   = duration;
+  for(uint8_t hid=0; hid<m_nDsp; hid++) {
+    if(mask & (1u<<hid)) {
+      WrData(adrCWR,m_shd[hid].cwr|cwrTEST,hid); // start selftest cwrTEST=1
+    }
+  }
+  commit();                           // the test starts now
+  m_busy = mask;                      // no access until finished
+}
+
+template<class Bus>
+void HDSP2112T<Bus>::pollTest(void) {
+  uint32_t elapsed = millis() - m_testStart;
+  if(elapsed < m_testDur) {
+    return;
+  }
+  uint16_t ok=0;
+  bool running=false;
+  for(uint8_t hid=0; hid<m_nDsp; hid++) {
+    if(m_testMask & (1u<<hid)) {
+      uint8_t data=RdData(adrCWR,hid); // read back control-word-register
+      running = running || (cwrTEST == (data&cwrTEST));
+      ok |= (cwrTSTOK == (data&cwrTSTOK)) ? (1u<<hid) : 0u;
+    }
+  }
+  if(running && (elapsed < msSELFTESTMAX)) {
+    m_testDur = elapsed + 500;        // slow clock, wait a little longer
+    return;
+  }
+  for(uint8_t hid=0; hid<m_nDsp; hid++) {
+    if(m_testMask & (1u<<hid)) {
+      HdspShadow &s = m_shd[hid];     // selftest blanks chars, flash, cwr
+      s.dChr   = 0xff;                // restore all chars
+      s.dFlash = s.flash;             // restore flash bits set
+      s.dCwr   = true;                // restore control-word
+    }
+  }
+  m_busy = 0;
+  Flush();
+  m_testOK  = ok;
+  m_testRun = false;
+  if(NULL!=m_testCb) {
+    m_testCb(ok,m_testMask);
+  }
+}
+
+template<class Bus>
+uint8_t HDSP2112T<Bus>::UTF8_to_HDSP(uint8_t utf8_ch) {
+  return m_ok ? m_utf8.Feed(utf8_ch) : 0; // state of this instance
+}
+
+
+// ----------------------------------------------------------------------------
+// virtual functions, derived from Print class
+// ----------------------------------------------------------------------------
+
+template<class Bus>
+size_t HDSP2112T<Bus>::write(const uint8_t *buffer, size_t size) {
+  HDSP_PROF(prfPrint);
+  bool af=m_autoFlush;
+  m_autoFlush=false;           // collect all chars, single flush
+  uint8_t chr[32];             // decoded chars of a part of the buffer
+  for(size_t ic=0; m_ok && (ic<size); ic+=sizeof(chr)) {
+    size_t len=(size-ic<sizeof(chr)) ? size-ic : sizeof(chr);
+    len=m_utf8.Decode(buffer+ic,len,chr); // map to HDSP2112 alphabet
+    for(size_t jc=0; (jc<len) && (m_pos<m_maxPos); jc++, m_pos++) {
+      storeChr(m_pos,chr[jc]);      // store char, flushed at once below
+    }
+  }
+  m_autoFlush=af;
+  if(m_autoFlush) {
+    Flush();
+  }
+  return size; 
+}
+
+template<class Bus>
+size_t HDSP2112T<Bus>::write(const uint8_t character){
+  uint8_t ch=UTF8_to_HDSP(character); // map to HDSP2112 alphabet
+  if('\0'!=ch) {
+    WriteChar(ch); // write if valid char
+  }
+  return 1;
+}
+
+#endif 
+//__HDSP2112_IMPL_H__
@@ -0,0 +1,181 @@
+#ifndef __HDSP2112_MARQUEE_H__
+#define __HDSP2112_MARQUEE_H__
+
+// scrolling marquee (ticker) for texts longer than the displays. The text
+// is scrolled within a window of the display line, one char per step at a
+// given speed with an optional pause at both ends. The marquee does not
+// block: Tick() is called periodically (loop(), a timer task, ...) and
+// does a step only if it is due. Every step rewrites the window in the
+// shadow ram, i.e. only the cells which changed are sent to the displays.
+// The marquee works with every driver HDSP2112T<Bus>.
+
+#include <stdint.h>
+#include "hdsp2112_utf8.h"
+
+// states of the marquee
+constexpr uint8_t mqIDLE   = 0;  // stopped or text fits into the window
+constexpr uint8_t mqSTART  = 1;  // showing the start of the text
+constexpr uint8_t mqSCROLL = 2;  // scrolling
+constexpr uint8_t mqEND    = 3;  // showing the end of the text
+
+template<class Drv>
+class HdspMarquee {
+  private:
+    Drv *m_drv;         // driver
+    uint8_t m_pos;      // first position of the window
+    uint8_t m_width;    // number of chars of the window
+
+    const char *m_text; // utf8 text, owned by the caller
+    const char *m_cur;  // first char within the window
+    HdspUtf8 m_utf8;    // utf8 decoder, independent of print()
+    uint8_t m_state;    // mqXXX
+    uint32_t m_step;    // time per step [µs]
+    uint32_t m_frac;    // remainder of the step time [1/cps µs]
+    uint32_t m_rem;     // accumulated remainder [1/cps µs]
+    uint16_t m_cps;     // speed [chars/s]
+    uint32_t m_pause;   // pause at both ends [µs]
+    uint32_t m_next;    // time of the next step micros()
+
+  public:
+    // constructor
+    // @param drv   driver
+    // @param pos   first position of the window
+    // @param width number of chars of the window (0=up to the end)
+    HdspMarquee(Drv &drv, uint8_t pos=0, uint8_t width=0) {
+      m_drv   = &drv;
+      m_pos   = pos;
+      m_width = width;
+      m_text  = NULL;
+      m_cur   = NULL;
+      m_state = mqIDLE;
+      m_step  = 0;
+      m_frac  = 0;
+      m_rem   = 0;
+      m_cps   = 1;
+      m_pause = 0;
+      m_next  = 0;
+    }
+
+    // starts scrolling a text, the start of the text is shown immediately.
+    // A text which fits into the window is shown without scrolling.
+    // @param text     utf8 text, must be valid until Stop()
+    // @param cps      speed [chars/s]
+    // @param pause_ms pause at the start and at the end of the text [ms]
+    void Start(const char *text, uint16_t cps, uint32_t pause_ms=0) {
+      uint8_t max = m_drv->GetDisplays() * nPOS;
+      if((0==m_width) || (m_pos+m_width > max)) {
+        m_width = (m_pos<max) ? max-m_pos : 0;
+      }
+      m_utf8.SetFallback(m_drv->GetFallback());
+      m_text  = (NULL!=text) ? text : "";
+      m_cur   = m_text;
+      m_cps   = (cps>0) ? cps : 1;
+      m_step  = 1000000ul / m_cps;    // µs per step
+      m_frac  = 1000000ul % m_cps;    // keeps the speed exact over time
+      m_rem   = 0;
+      m_pause = pause_ms * 1000ul;
+      m_next  = micros() + m_step + m_pause;
+      m_state = fits(m_cur) ? mqIDLE : mqSTART;
+      render();
+    }
+
+    // stops scrolling, the window keeps its content
+    inline void Stop(void) { m_state = mqIDLE; }
+
+    // checks if the marquee is scrolling
+    // @return 1=scrolling 0=stopped
+    inline bool Busy(void) { return mqIDLE!=m_state; }
+
+    // does all steps which are due, several missed steps are combined into
+    // a single update of the window
+    // @param now current time micros()
+    // @return 1=window updated 0=nothing to do
+    bool Tick(uint32_t now=micros()) {
+      bool upd=false;
+      for(uint8_t n=0; (mqIDLE!=m_state) && ((int32_t)(now-m_next) >= 0); n++) {
+        if(n>m_width) {
+          m_next = now;                // far behind, don't catch up
+        }
+        switch(m_state) {
+          case mqSTART:
+          case mqSCROLL: {
+            uint8_t ch;
+            m_cur   = glyph(m_cur,ch); // scroll by one char
+            m_state = fits(m_cur) ? mqEND : mqSCROLL;
+            advance((mqEND==m_state) ? m_pause : 0);
+            break;
+          }
+          case mqEND: {
+            m_cur   = m_text;          // start again
+            m_state = mqSTART;
+            advance(m_pause);
+            break;
+          }
+        }
+        upd=true;
+      }
+      if(upd) {
+        render();
+      }
+      return upd;
+    }
+
+  protected:
+    // schedules the next step
+    // @param extra additional time, e.g. pause [µs]
+    inline void advance(uint32_t extra) {
+      m_next += m_step + extra;
+      m_rem  += m_frac;
+      if(m_rem >= m_cps) {
+        m_rem -= m_cps;
+        m_next++;
+      }
+    }
+
+    // decodes the next printable char of a utf8 text
+    // @param p  text
+    // @param ch printable char, 0=end of text
+    // @return text after the char
+    inline const char *glyph(const char *p, uint8_t &ch) {
+      ch = 0;
+      m_utf8.Clear();                  // p is at the start of a char
+      while(('\0'!=*p) && (0==ch)) {
+        ch = m_utf8.Feed((uint8_t)*p++);
+      }
+      return p;
+    }
+
+    // checks if the rest of a text fits into the window
+    // @param p text
+    // @return 1=fits
+    inline bool fits(const char *p) {
+      uint8_t ch=1;
+      for(uint8_t ic=0; (ic<=m_width) && (0!=ch); ic++) {
+        p = glyph(p,ch);
+        if((ic==m_width) && (0!=ch)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // writes the window to the shadow ram and flushes it at once
+    void render(void) {
+      bool af=m_drv->GetAutoFlush();
+      uint8_t cur=m_drv->GetPos();
+      m_drv->AutoFlush(0);             // collect all chars, single flush
+      const char *p=m_cur;
+      for(uint8_t ic=0; ic<m_width; ic++) {
+        uint8_t ch;
+        p = glyph(p,ch);
+        m_drv->WriteChar(m_pos+ic,(0!=ch) ? ch : ' ');
+      }
+      m_drv->SetPos(cur);              // keep the cursor of the caller
+      if(af) {
+        m_drv->AutoFlush(1);           // unchanged chars are not written
+      }
+    }
+};
+
+#endif
+//__HDSP2112_MARQUEE_H__
@@ -0,0 +1,124 @@
+#ifndef __HDSP2112_PROF_H__
+#define __HDSP2112_PROF_H__
+
+// optional profiler of the driver, compiled in with -DHDSP2112_PROFILE.
+// It counts the bus transactions and bytes on the wire, the time spent in
+// delays of the driver and keeps a latency histogram of the public calls.
+// Without HDSP2112_PROFILE all hooks are empty and vanish completely.
+//
+//   hdspProf.Dump(Serial);     // print statistics
+//   hdspProf.Clear();          // start again
+
+#include "Arduino.h"
+
+// profiled calls
+constexpr uint8_t prfWriteChar  = 0;
+constexpr uint8_t prfWriteText  = 1;
+constexpr uint8_t prfPrint      = 2;   // write(buffer,size), print()
+constexpr uint8_t prfClear      = 3;
+constexpr uint8_t prfSetCwr     = 4;   // brightness, flash- and blink mode
+constexpr uint8_t prfSetFlash   = 5;
+constexpr uint8_t prfSetUdcFont = 6;
+constexpr uint8_t prfSetUdChar  = 7;
+constexpr uint8_t prfReset      = 8;
+constexpr uint8_t prfFlush      = 9;
+constexpr uint8_t prfService    = 10;
+constexpr uint8_t prfWrData     = 11;
+constexpr uint8_t prfRdData     = 12;
+constexpr uint8_t prfN          = 13;  // number of profiled calls
+
+// histogram bins, bin[0]=[0..1]µs bin[n]=[2^n..2^(n+1)-1]µs, the last bin
+// takes all longer calls
+constexpr uint8_t nPRFBIN       = 16;
+
+#ifdef HDSP2112_PROFILE
+
+// latency histogram of a single call
+struct HdspHist {
+  uint32_t n;                 // number of calls
+  uint32_t sum;               // total time [µs]
+  uint32_t max;               // max. time [µs]
+  uint32_t bin[nPRFBIN];      // number of calls per bin
+
+  // adds a single call
+  // @param us duration [µs]
+  inline void Add(uint32_t us) {
+    uint8_t ib = (us<2) ? 0 : 31 - __builtin_clz(us);
+    bin[(ib<nPRFBIN) ? ib : nPRFBIN-1]++;
+    n++;
+    sum += us;
+    max  = (us>max) ? us : max;
+  }
+};
+
+class HdspProf {
+  public:
+    uint32_t nTrn;            // number of bus transactions
+    uint32_t nBytes;          // number of bytes on the wire
+    uint32_t nDelay;          // number of delays
+    uint32_t usDelay;         // time spent in delays [µs]
+    HdspHist api[prfN];       // latency of the calls
+
+    HdspProf() { Clear(); }
+
+    // sets all counters to 0
+    inline void Clear(void) { 
+      nTrn = nBytes = nDelay = usDelay = 0;
+      memset(api,0,sizeof(api));
+    }
+
+    // prints all counters and histograms, e.g. to Serial
+    // @param out output
+    void Dump(Print &out);
+};
+
+// the profiler, defined in hdsp2112.cpp
+extern HdspProf hdspProf;
+
+// measures the latency of a call from construction until end of scope
+class HdspProfScope {
+  private:
+    uint8_t  m_id;            // call prfXXX
+    uint32_t m_t0;            // start micros()
+
+  public:
+    inline HdspProfScope(uint8_t id) : m_id(id), m_t0(micros()) {}
+    inline ~HdspProfScope() { hdspProf.api[m_id].Add(micros()-m_t0); }
+};
+
+// measures the latency of the enclosing call
+#define HDSP_PROF(id) HdspProfScope hdspProfScope_(id)
+
+// counts a bus transaction
+// @param bytes bytes on the wire
+inline void hdspProfTrn(uint8_t bytes) {
+  hdspProf.nTrn++;
+  hdspProf.nBytes += bytes;
+}
+
+// counted delay
+// @param us delay [µs]
+inline void hdspDelayUs(uint32_t us) {
+  hdspProf.nDelay++;
+  hdspProf.usDelay += us;
+  delayMicroseconds(us);
+}
+
+// counted delay
+// @param ms delay [ms]
+inline void hdspDelayMs(uint32_t ms) {
+  hdspProf.nDelay++;
+  hdspProf.usDelay += ms*1000ul;
+  delay(ms);
+}
+
+#else
+
+#define HDSP_PROF(id)
+inline void hdspProfTrn(uint8_t bytes) { (void)bytes; }
+inline void hdspDelayUs(uint32_t us) { delayMicroseconds(us); }
+inline void hdspDelayMs(uint32_t ms) { delay(ms); }
+
+#endif
+#endif
+//__HDSP2112_PROF_H__
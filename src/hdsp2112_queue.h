@@ -0,0 +1,99 @@
+#ifndef __HDSP2112_QUEUE_H__
+#define __HDSP2112_QUEUE_H__
+
+// lock-free single-producer single-consumer ring buffer, used to post
+// commands from the caller to the render task without blocking
+
+#include <atomic>
+#include <stdint.h>
+
+#ifdef ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// identifies the calling task
+inline const void *hdspContext(void) { return xTaskGetCurrentTaskHandle(); }
+#else
+// identifies the calling thread
+inline const void *hdspContext(void) { 
+  static thread_local char tag; 
+  return &tag; 
+}
+#endif
+
+// single command posted to the render task
+struct HdspCmd {
+  uint8_t  op;        // command, see cmdXXX
+  uint8_t  a;         // 1st parameter, e.g. position
+  uint8_t  b;         // 2nd parameter, e.g. character
+  uint32_t v;         // 32 bit parameter, e.g. flash bits or control-word
+  const uint8_t *p;   // pointer parameter, e.g. user defined char
+  uint32_t t;         // time stamp micros() when posted
+};
+
+// commands of the render task, fade = number of the last Fade() call
+constexpr uint8_t cmdFLUSH = 0;  // write shadow ram to displays
+constexpr uint8_t cmdTEXT  = 1;  // a=first pos, b=number of chars, the chars
+                                 // are read from the copy of the caller
+constexpr uint8_t cmdCWR   = 2;  // a=bits, b=control-word, v=displays mask
+constexpr uint8_t cmdFLB   = 3;  // a=pos, b=number of chars, v=flash bits
+constexpr uint8_t cmdUDC   = 4;  // a=index, p=user defined char
+constexpr uint8_t cmdFONT  = 5;  // a=number of chars, b=fade, p=font,
+                                 // v=control-word
+constexpr uint8_t cmdRESET = 6;  // b=fade, v=control-word after reset
+constexpr uint8_t cmdTEST  = 7;  // a,b=displays mask low,high, v=duration [ms]
+constexpr uint8_t cmdFADE  = 8;  // a=level, b=fade,
+                                 // v=displays mask | duration [ms]<<16
+constexpr uint8_t cmdPRESENT = 9; // flush, chars position by position
+constexpr uint8_t cmdCLEAR = 10; // clear all displays by cwrCLEAR
+
+// ring buffer with N entries, N must be a power of 2
+template<class T, uint16_t N>
+class HdspQueue {
+  static_assert((N>=2) && (0==(N & (N-1))), "N must be a power of 2");
+
+  private:
+    T m_buf[N];                       // entries
+    std::atomic<uint16_t> m_head;     // next entry to write (producer)
+    std::atomic<uint16_t> m_tail;     // next entry to read  (consumer)
+
+  public:
+    HdspQueue() : m_head(0), m_tail(0) {}
+
+    // appends an entry, called by the producer only
+    // @param item entry
+    // @return 1=OK 0=queue full
+    inline bool Push(const T &item) {
+      uint16_t head = m_head.load(std::memory_order_relaxed);
+      uint16_t tail = m_tail.load(std::memory_order_acquire);
+      if((uint16_t)(head - tail) >= N) {
+        return false;
+      }
+      m_buf[head & (N-1)] = item;
+      m_head.store(head + 1, std::memory_order_release);
+      return true;
+    }
+
+    // removes the oldest entry, called by the consumer only
+    // @param item entry
+    // @return 1=OK 0=queue empty
+    inline bool Pop(T &item) {
+      uint16_t tail = m_tail.load(std::memory_order_relaxed);
+      uint16_t head = m_head.load(std::memory_order_acquire);
+      if(head == tail) {
+        return false;
+      }
+      item = m_buf[tail & (N-1)];
+      m_tail.store(tail + 1, std::memory_order_release);
+      return true;
+    }
+
+    // @return number of entries in queue
+    inline uint16_t Size(void) {
+      return (uint16_t)(m_head.load(std::memory_order_acquire) -
+                        m_tail.load(std::memory_order_acquire));
+    }
+};
+
+#endif
+//__HDSP2112_QUEUE_H__
@@ -0,0 +1,143 @@
+#ifndef __HDSP2112_UDC_CACHE_H__
+#define __HDSP2112_UDC_CACHE_H__
+
+// slot manager of the user defined chars. A glyph library in flash may
+// hold more glyphs than the 16 slots of the UDC-RAM, Glyph() returns the
+// char of a glyph and uploads it only if it is not yet resident. If all
+// slots are used, the least recently used slot is replaced, slots shown on
+// the displays are kept. Only the rows which differ from the old glyph are
+// written and the displays are not reset, i.e. the chars on the displays
+// stay as they are. With the glyph hashes of the library (UDC_hash, see
+// tools/udcgen.py) glyphs with equal rows share a slot, whatever their id.
+// The cache works with every driver HDSP2112T<Bus>.
+//
+//   HdspUdcCache<HDSP2112> udc(d,UDC_lib,UDC_nLib,0,UDC_nch,UDC_hash);
+//   d.WriteChar(0,udc.Glyph(UDC_idFont+9));   // heart
+
+#include <stdint.h>
+#include <string.h>
+#include "hdsp2112_utf8.h"
+
+constexpr uint16_t udcFREE = 0xffff;  // slot without glyph
+
+template<class Drv>
+class HdspUdcCache {
+  private:
+    Drv *m_drv;                 // driver
+    const uint8_t *m_lib;       // glyph library, UDC_rows bytes per glyph
+    const uint16_t *m_hash;     // hash of each glyph, NULL=ids only
+    uint16_t m_nGlyphs;         // number of glyphs in the library
+    uint8_t  m_first;           // first slot of the cache
+    uint8_t  m_nSlots;          // number of slots of the cache
+    uint16_t m_id[UDC_nch];     // glyph id of each slot, udcFREE=unused
+    uint32_t m_use[UDC_nch];    // time of the last use of each slot
+    uint32_t m_clock;           // counts the calls of Glyph()
+    uint32_t m_uploads;         // number of uploaded glyphs
+    uint32_t m_hits;            // number of resident glyphs found
+
+  public:
+    // constructor, the slots outside [first..first+nSlots-1] stay free for
+    // fixed chars, e.g. the € of UDC_font
+    // @param drv     driver
+    // @param lib     glyph library, 5 cols x 7 rows per glyph
+    // @param nGlyphs number of glyphs in the library
+    // @param first   first slot used by the cache
+    // @param nSlots  number of slots used by the cache
+    // @param hash    hash of each glyph, e.g. UDC_hash (NULL=ids only)
+    HdspUdcCache(Drv &drv, const uint8_t *lib, uint16_t nGlyphs,
+                 uint8_t first=0, uint8_t nSlots=UDC_nch,
+                 const uint16_t *hash=NULL) {
+      m_drv     = &drv;
+      m_lib     = lib;
+      m_hash    = hash;
+      m_nGlyphs = nGlyphs;
+      m_first   = (first<UDC_nch) ? first : UDC_nch-1;
+      m_nSlots  = (m_first+nSlots <= UDC_nch) ? nSlots : UDC_nch-m_first;
+      m_uploads = 0;
+      m_hits    = 0;
+      Invalidate();
+    }
+
+    // gets the char of a glyph, the glyph is uploaded if not yet resident.
+    // With AutoFlush(0) several uploads are written by the next Flush().
+    // @param id glyph id, index within the library
+    // @return char of the hdsp2112 [128..143], '\0'=unknown id or all
+    //         slots are shown on the displays
+    uint8_t Glyph(uint16_t id) {
+      if(id>=m_nGlyphs) {
+        return '\0';
+      }
+      m_clock++;
+      for(uint8_t is=0; is<m_nSlots; is++) {
+        if((m_id[is]==id) || same(m_id[is],id)) {
+          m_use[is] = m_clock;         // resident
+          m_hits++;
+          return utf8Ascii + m_first + is;
+        }
+      }
+      uint8_t is = victim();
+      if(is>=m_nSlots) {
+        return '\0';
+      }
+      m_id[is]  = id;
+      m_use[is] = m_clock;
+      m_uploads++;
+      m_drv->SetUdChar(m_lib + (uint32_t)id*UDC_rows, m_first+is);
+      return utf8Ascii + m_first + is;
+    }
+
+    // marks all slots free, e.g. after SetUdcFont(). The UDC-RAM keeps its
+    // content, a glyph loaded again writes only the rows which differ.
+    inline void Invalidate(void) {
+      for(uint8_t is=0; is<UDC_nch; is++) {
+        m_id[is]  = udcFREE;
+        m_use[is] = 0;
+      }
+      m_clock = 0;
+    }
+
+    // @return number of uploaded glyphs
+    inline uint32_t GetUploads(void) { return m_uploads; }
+
+    // @return number of glyphs found in the cache
+    inline uint32_t GetHits(void) { return m_hits; }
+
+  protected:
+    // checks if a resident glyph has the same rows as another glyph, the
+    // hashes are compared first
+    // @param res glyph id of a slot, udcFREE=unused
+    // @param id  glyph id
+    // @return 1=same rows 0=different or no hashes
+    inline bool same(uint16_t res, uint16_t id) {
+      return (NULL!=m_hash) && (udcFREE!=res) && (m_hash[res]==m_hash[id]) &&
+             (0==memcmp(m_lib+(uint32_t)res*UDC_rows,m_lib+(uint32_t)id*UDC_rows,UDC_rows));
+    }
+
+    // finds the slot for a new glyph, a free one or the least recently
+    // used slot which is not shown on the displays
+    // @return slot [0..nSlots-1], nSlots=none
+    uint8_t victim(void) {
+      uint16_t shown = 0;              // slots shown on the displays
+      uint8_t  max = m_drv->GetDisplays() * nPOS;
+      for(uint8_t pos=0; pos<max; pos++) {
+        uint8_t ch = m_drv->GetChar(pos);
+        if((ch>=utf8Ascii+m_first) && (ch<utf8Ascii+m_first+m_nSlots)) {
+          shown |= 1u << (ch-utf8Ascii-m_first);
+        }
+      }
+      uint8_t best = m_nSlots;
+      for(uint8_t is=0; is<m_nSlots; is++) {
+        if(udcFREE==m_id[is]) {
+          return is;
+        }
+        if(!(shown & (1u<<is)) &&
+           ((best>=m_nSlots) || (m_use[is]<m_use[best]))) {
+          best = is;
+        }
+      }
+      return best;
+    }
+};
+
+#endif
+//__HDSP2112_UDC_CACHE_H__
@@ -1,78 +1,156 @@
 #ifndef __HDSP2112_UDC_FONT_H__
 #define __HDSP2112_UDC_FONT_H__
 
-// example of user defined characters with 5 columns x 7 rows
+// user defined characters with 5 columns x 7 rows, generated by
+// tools/udcgen.py from font/hdsp2112_udc.txt, do not edit
 
 #include <hdsp2112.h>
 
+// chars of the named glyphs, valid while their font is loaded
+constexpr uint8_t wDot0      = 128;   // wipe
+constexpr uint8_t wDot1      = 129;   // wipe
+constexpr uint8_t wDot2      = 130;   // wipe
+constexpr uint8_t wDot3      = 131;   // wipe
+constexpr uint8_t wDown0     = 132;   // wipe
+constexpr uint8_t wDown1     = 133;   // wipe
+constexpr uint8_t wDown2     = 134;   // wipe
+constexpr uint8_t wDown3     = 135;   // wipe
+constexpr uint8_t wDown4     = 136;   // wipe
+constexpr uint8_t wDown5     = 137;   // wipe
+constexpr uint8_t wDown6     = 138;   // wipe
+constexpr uint8_t wRight0    = 139;   // wipe
+constexpr uint8_t wRight1    = 140;   // wipe
+constexpr uint8_t wRight2    = 141;   // wipe
+constexpr uint8_t wRight3    = 142;   // wipe
+constexpr uint8_t wRight4    = 143;   // wipe
+constexpr uint8_t cHand0     = 128;   // font
+constexpr uint8_t cHand1     = 129;   // font
+constexpr uint8_t cHand2     = 130;   // font
+constexpr uint8_t cHand3     = 131;   // font
+constexpr uint8_t cHand4     = 132;   // font
+constexpr uint8_t cHand5     = 133;   // font
+constexpr uint8_t cHand6     = 134;   // font
+constexpr uint8_t cHand7     = 135;   // font
+constexpr uint8_t cCircle    = 136;   // font
+constexpr uint8_t cHeart     = 137;   // font
+constexpr uint8_t tRight     = 138;   // font
+constexpr uint8_t tBar       = 139;   // font
+constexpr uint8_t cEuro      = 140;   // font
+constexpr uint8_t aUp        = 141;   // font
+constexpr uint8_t aLeft      = 142;   // font
+constexpr uint8_t aDown      = 143;   // font
 
-// arrows 
-constexpr uint8_t aUp    = 141; 
-constexpr uint8_t aRight = 27; 
-constexpr uint8_t aDown  = 143; 
-constexpr uint8_t aLeft  = 142; 
+// chars of the built-in character set
+constexpr uint8_t aRight     = 27;
+constexpr uint8_t tLeft      = 0;
 
-// triangles 
-constexpr uint8_t tLeft  = 0; 
-constexpr uint8_t tBar   = 139; 
-constexpr uint8_t tRight = 138; 
-
-// font size 5 x 7 
-constexpr uint8_t UDC_nch  = 16;   // number of user defined chars
-constexpr uint8_t UDC_rows = 7;    // rows per character
+// font size 5 x 7 (UDC_nch and UDC_rows see hdsp2112.h)
 constexpr uint8_t UDC_size = UDC_nch * UDC_rows; // font-size 
 
-// wipe left/right up/down, animated dot
-const uint8_t UDC_wipe[UDC_size] {
-  // [128..131] animated dot to square, 4 chars
-  0b00000, 0b00000, 0b00000, 0b00100, 0b00000, 0b00000, 0b00000,
-  0b00000, 0b00000, 0b01110, 0b01010, 0b01110, 0b00000, 0b00000,
-  0b00000, 0b11111, 0b10001, 0b10001, 0b10001, 0b11111, 0b00000,
-  0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000,
-  // [132..138] up-->down with 7 characters
-  0b11111, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000,
-  0b00000, 0b11111, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000,
-  0b00000, 0b00000, 0b11111, 0b00000, 0b00000, 0b00000, 0b00000,
-  0b00000, 0b00000, 0b00000, 0b11111, 0b00000, 0b00000, 0b00000,
-  0b00000, 0b00000, 0b00000, 0b00000, 0b11111, 0b00000, 0b00000,
-  0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11111, 0b00000,
-  0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11111,
-  // [139..144] left-->right with 5 characters
-  0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000,
-  0b01000, 0b01000, 0b01000, 0b01000, 0b01000, 0b01000, 0b01000,
-  0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100,
-  0b00010, 0b00010, 0b00010, 0b00010, 0b00010, 0b00010, 0b00010,
-  0b00001, 0b00001, 0b00001, 0b00001, 0b00001, 0b00001, 0b00001
+// library of all glyphs, the fonts follow each other, e.g. as glyph
+// library of HdspUdcCache (glyph id = index)
+constexpr uint16_t UDC_idWipe   = 0;       // first glyph of UDC_wipe
+constexpr uint8_t  UDC_nWipe    = 16;      // glyphs of UDC_wipe
+constexpr uint16_t UDC_idFont   = 16;      // first glyph of UDC_font
+constexpr uint8_t  UDC_nFont    = 16;      // glyphs of UDC_font
+constexpr uint16_t UDC_nLib     = 32;      // number of glyphs
+
+constexpr uint8_t UDC_lib[UDC_nLib * UDC_rows] = {
+  // UDC_wipe
+  // animated dot to square
+  0b00000, 0b00000, 0b00000, 0b00100, 0b00000, 0b00000, 0b00000,   // [128] wDot0
+  0b00000, 0b00000, 0b01110, 0b01010, 0b01110, 0b00000, 0b00000,   // [129] wDot1
+  0b00000, 0b11111, 0b10001, 0b10001, 0b10001, 0b11111, 0b00000,   // [130] wDot2
+  0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000,   // [131] wDot3
+  // up-->down with 7 characters
+  0b11111, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000,   // [132] wDown0
+  0b00000, 0b11111, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000,   // [133] wDown1
+  0b00000, 0b00000, 0b11111, 0b00000, 0b00000, 0b00000, 0b00000,   // [134] wDown2
+  0b00000, 0b00000, 0b00000, 0b11111, 0b00000, 0b00000, 0b00000,   // [135] wDown3
+  0b00000, 0b00000, 0b00000, 0b00000, 0b11111, 0b00000, 0b00000,   // [136] wDown4
+  0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11111, 0b00000,   // [137] wDown5
+  0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11111,   // [138] wDown6
+  // left-->right with 5 characters
+  0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000,   // [139] wRight0
+  0b01000, 0b01000, 0b01000, 0b01000, 0b01000, 0b01000, 0b01000,   // [140] wRight1
+  0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100,   // [141] wRight2
+  0b00010, 0b00010, 0b00010, 0b00010, 0b00010, 0b00010, 0b00010,   // [142] wRight3
+  0b00001, 0b00001, 0b00001, 0b00001, 0b00001, 0b00001, 0b00001,   // [143] wRight4
+  // UDC_font
+  // clock hands, 8 characters
+  0b00100, 0b00100, 0b00100, 0b00100, 0b00000, 0b00000, 0b00000,   // [128] cHand0
+  0b00000, 0b00001, 0b00010, 0b00100, 0b00000, 0b00000, 0b00000,   // [129] cHand1
+  0b00000, 0b00000, 0b00000, 0b00111, 0b00000, 0b00000, 0b00000,   // [130] cHand2
+  0b00000, 0b00000, 0b00000, 0b00100, 0b00010, 0b00001, 0b00000,   // [131] cHand3
+  0b00000, 0b00000, 0b00000, 0b00100, 0b00100, 0b00100, 0b00100,   // [132] cHand4
+  0b00000, 0b00000, 0b00000, 0b00100, 0b01000, 0b10000, 0b00000,   // [133] cHand5
+  0b00000, 0b00000, 0b00000, 0b11100, 0b00000, 0b00000, 0b00000,   // [134] cHand6
+  0b00000, 0b10000, 0b01000, 0b00100, 0b00000, 0b00000, 0b00000,   // [135] cHand7
+  // filled circle
+  0b00000, 0b01110, 0b11111, 0b11111, 0b11110, 0b01110, 0b00000,   // [136] cCircle
+  // heart
+  0b00000, 0b01010, 0b11111, 0b11111, 0b01110, 0b00100, 0b00000,   // [137] cHeart
+  // triangle right
+  0b01000, 0b01100, 0b01110, 0b01111, 0b01110, 0b01100, 0b01000,   // [138] tRight
+  // bar
+  0b00000, 0b00000, 0b11111, 0b11111, 0b11111, 0b00000, 0b00000,   // [139] tBar
+  // euro sign, also shown for the utf8 sequence of U+20AC
+  0b00111, 0b01000, 0b11110, 0b01000, 0b11110, 0b01000, 0b00111,   // [140] cEuro U+20AC
+  // arrows up, left and down
+  0b00100, 0b01110, 0b10101, 0b00100, 0b00100, 0b00100, 0b00100,   // [141] aUp
+  0b00000, 0b00100, 0b01000, 0b11111, 0b01000, 0b00100, 0b00000,   // [142] aLeft
+  0b00100, 0b00100, 0b00100, 0b00100, 0b10101, 0b01110, 0b00100,   // [143] aDown
+};
+
+// hash of each glyph (FNV-1a of the rows, folded to 16 bit), glyphs
+// with different hash differ, e.g. for the lookup of HdspUdcCache
+constexpr uint16_t UDC_hash[UDC_nLib] = {
+  0x7a9a, 0xe947, 0xfe0e, 0x3a0d, 0x8d95, 0xc2c1, 0x4598, 0x59ba,
+  0x55ae, 0x9abc, 0x7a8c, 0x1bb2, 0x7a1d, 0xff2c, 0x32bf, 0x2e35,
+  0x4917, 0x0dda, 0xd644, 0x3154, 0x04bd, 0x90e7, 0x034c, 0xc8e4,
+  0x1c13, 0x3985, 0xc803, 0x37f7, 0x00d1, 0x92fd, 0x41a3, 0x69d7,
 };
 
-// extended font with clock, arrows and € char
+// fonts, e.g. for SetUdcFont(UDC_font,UDC_nch), same rows as UDC_lib
+const uint8_t UDC_wipe[UDC_size] = {
+  0b00000, 0b00000, 0b00000, 0b00100, 0b00000, 0b00000, 0b00000,   // [128] wDot0
+  0b00000, 0b00000, 0b01110, 0b01010, 0b01110, 0b00000, 0b00000,   // [129] wDot1
+  0b00000, 0b11111, 0b10001, 0b10001, 0b10001, 0b11111, 0b00000,   // [130] wDot2
+  0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000,   // [131] wDot3
+  0b11111, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000,   // [132] wDown0
+  0b00000, 0b11111, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000,   // [133] wDown1
+  0b00000, 0b00000, 0b11111, 0b00000, 0b00000, 0b00000, 0b00000,   // [134] wDown2
+  0b00000, 0b00000, 0b00000, 0b11111, 0b00000, 0b00000, 0b00000,   // [135] wDown3
+  0b00000, 0b00000, 0b00000, 0b00000, 0b11111, 0b00000, 0b00000,   // [136] wDown4
+  0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11111, 0b00000,   // [137] wDown5
+  0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11111,   // [138] wDown6
+  0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000,   // [139] wRight0
+  0b01000, 0b01000, 0b01000, 0b01000, 0b01000, 0b01000, 0b01000,   // [140] wRight1
+  0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100,   // [141] wRight2
+  0b00010, 0b00010, 0b00010, 0b00010, 0b00010, 0b00010, 0b00010,   // [142] wRight3
+  0b00001, 0b00001, 0b00001, 0b00001, 0b00001, 0b00001, 0b00001,   // [143] wRight4
+};
 const uint8_t UDC_font[UDC_size] = {
-  // [128...135] clock hands, 8 characters
-  0b00100, 0b00100, 0b00100, 0b00100, 0b00000, 0b00000, 0b00000,
-  0b00000, 0b00001, 0b00010, 0b00100, 0b00000, 0b00000, 0b00000,
-  0b00000, 0b00000, 0b00000, 0b00111, 0b00000, 0b00000, 0b00000,
-  0b00000, 0b00000, 0b00000, 0b00100, 0b00010, 0b00001, 0b00000,
-  0b00000, 0b00000, 0b00000, 0b00100, 0b00100, 0b00100, 0b00100,
-  0b00000, 0b00000, 0b00000, 0b00100, 0b01000, 0b10000, 0b00000,
-  0b00000, 0b00000, 0b00000, 0b11100, 0b00000, 0b00000, 0b00000,
-  0b00000, 0b10000, 0b01000, 0b00100, 0b00000, 0b00000, 0b00000,
-  // 136 filled circle 
-  0b00000, 0b01110, 0b11111, 0b11111, 0b11110, 0b01110, 0b00000,
-  // 137 heart
-  0b00000, 0b01010, 0b11111, 0b11111, 0b01110, 0b00100, 0b00000,
-  // 138 triangle right
-  0b01000, 0b01100, 0b01110, 0b01111, 0b01110, 0b01100, 0b01000,
-  // 139 bar
-  0b00000, 0b00000, 0b11111, 0b11111, 0b11111, 0b00000, 0b00000,
-  // 140: € sign
-  0b00111, 0b01000, 0b11110, 0b01000, 0b11110, 0b01000, 0b00111,
-  // 141 arrow up
-  0b00100, 0b01110, 0b10101, 0b00100, 0b00100, 0b00100, 0b00100, 
-  // 142 arrow left
-  0b00000, 0b00100, 0b01000, 0b11111, 0b01000, 0b00100, 0b00000,
-  // 143 arrow down
-  0b00100, 0b00100, 0b00100, 0b00100, 0b10101, 0b01110, 0b00100
+  0b00100, 0b00100, 0b00100, 0b00100, 0b00000, 0b00000, 0b00000,   // [128] cHand0
+  0b00000, 0b00001, 0b00010, 0b00100, 0b00000, 0b00000, 0b00000,   // [129] cHand1
+  0b00000, 0b00000, 0b00000, 0b00111, 0b00000, 0b00000, 0b00000,   // [130] cHand2
+  0b00000, 0b00000, 0b00000, 0b00100, 0b00010, 0b00001, 0b00000,   // [131] cHand3
+  0b00000, 0b00000, 0b00000, 0b00100, 0b00100, 0b00100, 0b00100,   // [132] cHand4
+  0b00000, 0b00000, 0b00000, 0b00100, 0b01000, 0b10000, 0b00000,   // [133] cHand5
+  0b00000, 0b00000, 0b00000, 0b11100, 0b00000, 0b00000, 0b00000,   // [134] cHand6
+  0b00000, 0b10000, 0b01000, 0b00100, 0b00000, 0b00000, 0b00000,   // [135] cHand7
+  0b00000, 0b01110, 0b11111, 0b11111, 0b11110, 0b01110, 0b00000,   // [136] cCircle
+  0b00000, 0b01010, 0b11111, 0b11111, 0b01110, 0b00100, 0b00000,   // [137] cHeart
+  0b01000, 0b01100, 0b01110, 0b01111, 0b01110, 0b01100, 0b01000,   // [138] tRight
+  0b00000, 0b00000, 0b11111, 0b11111, 0b11111, 0b00000, 0b00000,   // [139] tBar
+  0b00111, 0b01000, 0b11110, 0b01000, 0b11110, 0b01000, 0b00111,   // [140] cEuro
+  0b00100, 0b01110, 0b10101, 0b00100, 0b00100, 0b00100, 0b00100,   // [141] aUp
+  0b00000, 0b00100, 0b01000, 0b11111, 0b01000, 0b00100, 0b00000,   // [142] aLeft
+  0b00100, 0b00100, 0b00100, 0b00100, 0b10101, 0b01110, 0b00100,   // [143] aDown
 };
 
+// code points of the glyphs, see hdsp2112_utf8_map.h
+static_assert(utf8Glyph(0x20ac)==cEuro, "utf8 map of cEuro is outdated");
+
 #endif 
 //__HDSP2112_UDC_FONT_H__
@@ -0,0 +1,119 @@
+#ifndef __HDSP2112_UTF8_H__
+#define __HDSP2112_UTF8_H__
+
+// utf8 decoder of the HDSP2112T<Bus> driver. The utf8 sequences are
+// decoded into unicode code points by a table of the lead bytes, the code
+// points are mapped to the character set of the hdsp2112 by a perfect hash
+// table generated by tools/udcgen.py. Both tables are constexpr, the lookup
+// can also be used at compile time, e.g. utf8Glyph(0x20ac) is the € char of
+// UDC_font.
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ranges for ascii and extended user defined chars
+constexpr uint8_t utf8Ascii= 128;            // ascii chars
+constexpr uint8_t utf8chUDC= utf8Ascii+16;   // user defined chars
+
+// char of the hdsp2112 character set for a unicode code point
+struct HdspGlyph {
+  uint16_t cp;        // unicode code point
+  uint8_t  ch;        // char of the hdsp2112
+};
+
+// all code points above ascii, which can be shown (generated table)
+#include "hdsp2112_utf8_map.h"
+
+// entry of a code point within utf8Glyphs
+// @param cp unicode code point
+// @return index within utf8Glyphs
+constexpr uint32_t utf8Hash(uint32_t cp) {
+  return (uint32_t)(cp * utf8HashMul) >> (32 - utf8HashBits);
+}
+
+// finds the char of a code point by a single lookup within utf8Glyphs
+// @param cp unicode code point
+// @return char of the hdsp2112, 0=not found
+constexpr uint8_t utf8Glyph(uint32_t cp) {
+  return (utf8Glyphs[utf8Hash(cp)].cp == cp) ? utf8Glyphs[utf8Hash(cp)].ch : 0;
+}
+
+// number of continuation bytes after a lead byte, index = byte>>3
+constexpr uint8_t utf8Bad  = 0xff;           // no lead byte
+constexpr uint8_t utf8Cont[32] = {
+  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,           // 0x00..0x7f ascii
+  utf8Bad,utf8Bad,utf8Bad,utf8Bad,           // 0x80..0xbf continuation
+  utf8Bad,utf8Bad,utf8Bad,utf8Bad,
+  1,1,1,1,                                   // 0xc0..0xdf 2 byte sequence
+  2,2,                                       // 0xe0..0xef 3 byte sequence
+  3,                                         // 0xf0..0xf7 4 byte sequence
+  utf8Bad                                    // 0xf8..0xff invalid
+};
+
+// decoder state of a single utf8 stream, e.g. of a driver instance
+class HdspUtf8 {
+  private:
+    uint32_t m_cp;      // code point of the current sequence
+    uint8_t  m_need;    // continuation bytes still missing
+    uint8_t  m_fallback;// char for code points without glyph (0=skip)
+
+  public:
+    HdspUtf8() : m_cp(0), m_need(0), m_fallback(0) {}
+
+    // drops a started sequence
+    inline void Clear(void) { m_need = 0; }
+
+    // sets the char shown for code points without glyph
+    // @param ch char of the hdsp2112 (0=skip these code points)
+    inline void SetFallback(uint8_t ch) { m_fallback = ch; }
+
+    // @return char shown for code points without glyph
+    inline uint8_t GetFallback(void) { return m_fallback; }
+
+    // decodes a single byte. Chars [0..127] are passed directly, single
+    // bytes [128..143] (no valid utf8) select the user defined chars.
+    // @param b byte of the utf8 stream
+    // @return char of the hdsp2112, 0=none (sequence not yet complete)
+    inline uint8_t Feed(uint8_t b) {
+      uint8_t n = utf8Cont[b>>3];
+      if(m_need>0) {
+        if(utf8Bad==n) {                      // continuation byte
+          m_cp = (m_cp<<6) | (b & 0x3f);
+          if(0 == --m_need) {
+            uint8_t ch = utf8Glyph(m_cp);
+            return (0!=ch) ? ch : m_fallback;
+          }
+          return 0;
+        }
+        m_need = 0;                           // broken sequence, drop it
+      }
+      if(0==n) {
+        return b;                             // ascii
+      }
+      if(utf8Bad==n) {
+        return (b<utf8chUDC) ? b : m_fallback;// user defined char or invalid
+      }
+      m_cp   = b & (0x3f>>n);                 // payload of the lead byte
+      m_need = n;
+      return 0;
+    }
+
+    // decodes a buffer, a sequence may continue in the next buffer
+    // @param in   utf8 bytes
+    // @param size number of bytes
+    // @param out  chars of the hdsp2112, at most size chars
+    // @return number of chars
+    inline size_t Decode(const uint8_t *in, size_t size, uint8_t *out) {
+      size_t n=0;
+      for(size_t ic=0; ic<size; ic++) {
+        uint8_t ch = Feed(in[ic]);
+        if(0!=ch) {
+          out[n++] = ch;
+        }
+      }
+      return n;
+    }
+};
+
+#endif
+//__HDSP2112_UTF8_H__
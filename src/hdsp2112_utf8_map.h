@@ -0,0 +1,82 @@
+#ifndef __HDSP2112_UTF8_MAP_H__
+#define __HDSP2112_UTF8_MAP_H__
+
+// code points above ascii, which can be shown, generated by
+// tools/udcgen.py from font/hdsp2112_charset.txt and
+// font/hdsp2112_udc.txt, do not edit. Perfect hash: each code point
+// has its own entry at utf8Hash(cp), a lookup is a single compare,
+// see utf8Glyph().
+
+constexpr uint32_t utf8HashMul  = 0xc623a9b1;
+constexpr uint8_t  utf8HashBits = 6;
+constexpr size_t   utf8nGlyphs  = 29;   // code points in the table
+
+constexpr HdspGlyph utf8Glyphs[1u<<utf8HashBits] = {
+  { 0x0000, 0x00 },
+  { 0x03c0, 0x0d },   // pi
+  { 0x00fc, 0x1a },   // ü
+  { 0x03b7, 0x09 },   // eta
+  { 0x0000, 0x00 },
+  { 0x00b5, 0x0c },   // µ micro sign
+  { 0x0000, 0x00 },
+  { 0x03c4, 0x10 },   // tau
+  { 0x0000, 0x00 },
+  { 0x03bb, 0x0b },   // lambda
+  { 0x00a3, 0x1e },   // POUND sign
+  { 0x03b2, 0x06 },   // beta
+  { 0x0393, 0x1c },   // GAMMA
+  { 0x0000, 0x00 },
+  { 0x03a9, 0x12 },   // OMEGA
+  { 0x00e5, 0x14 },   // a-dot
+  { 0x0000, 0x00 },
+  { 0x00dc, 0x19 },   // Ü
+  { 0x0000, 0x00 },
+  { 0x0000, 0x00 },
+  { 0x0000, 0x00 },
+  { 0x0000, 0x00 },
+  { 0x03c3, 0x0e },   // sigma
+  { 0x0000, 0x00 },
+  { 0x0000, 0x00 },
+  { 0x00f6, 0x18 },   // ö
+  { 0x03b1, 0x05 },   // alpha
+  { 0x0000, 0x00 },
+  { 0x0000, 0x00 },
+  { 0x00e4, 0x16 },   // ä
+  { 0x00c5, 0x13 },   // A-dot
+  { 0x0000, 0x00 },
+  { 0x0000, 0x00 },
+  { 0x0000, 0x00 },
+  { 0x0000, 0x00 },
+  { 0x0000, 0x00 },
+  { 0x03a3, 0x0f },   // SIGMA
+  { 0x20ac, 140  },   // cEuro of UDC_font
+  { 0x00df, 0x06 },   // ß
+  { 0x0000, 0x00 },
+  { 0x00d6, 0x17 },   // Ö
+  { 0x0000, 0x00 },
+  { 0x0000, 0x00 },
+  { 0x0000, 0x00 },
+  { 0x00c4, 0x15 },   // Ä
+  { 0x00a5, 0x1f },   // YEN sign
+  { 0x0000, 0x00 },
+  { 0x03b4, 0x07 },   // delta
+  { 0x0000, 0x00 },
+  { 0x00b2, 0x1d },   // 2 superscript
+  { 0x0000, 0x00 },
+  { 0x0000, 0x00 },
+  { 0x0000, 0x00 },
+  { 0x03b8, 0x0a },   // theta
+  { 0x0000, 0x00 },
+  { 0x0000, 0x00 },
+  { 0x0000, 0x00 },
+  { 0x03a6, 0x11 },   // PHI
+  { 0x0000, 0x00 },
+  { 0x03bc, 0x0c },   // mu
+  { 0x0000, 0x00 },
+  { 0x0394, 0x08 },   // DELTA
+  { 0x0000, 0x00 },
+  { 0x0000, 0x00 },
+};
+
+#endif
+//__HDSP2112_UTF8_MAP_H__
@@ -0,0 +1,138 @@
+#ifndef __HDSP2112_WINDOW_H__
+#define __HDSP2112_WINDOW_H__
+
+// window (viewport) within the display line, e.g. for a clock, a status
+// and a value field side by side. A window has a first position, a width,
+// its own cursor and an alignment, all positions are relative to the
+// window and all output is clipped at its borders. The windows write into
+// the shadow ram of the driver only, with AutoFlush(0) a single Flush()
+// of the driver commits the changed chars of all windows at once. The
+// window works with every driver HDSP2112T<Bus>.
+//
+//   HdspWindow<HDSP2112> clk(d,0,5), val(d,8,8,alRIGHT);
+//   d.AutoFlush(0);
+//   clk.WriteText("%02d:%02d",h,m);
+//   val.WriteText("%.1f V",u);
+//   d.Flush();                        // both windows, one flush
+
+#include <stdint.h>
+#include <stdarg.h>
+#include "hdsp2112_fmt.h"
+#include "hdsp2112_utf8.h"
+
+template<class Drv>
+class HdspWindow : public Print {
+  private:
+    Drv *m_drv;         // driver
+    const char *m_name; // name of the window, e.g. for debug output
+    uint8_t m_pos;      // first position of the window
+    uint8_t m_width;    // number of chars of the window
+    uint8_t m_align;    // alignment of WriteText(), alLEFT, alRIGHT, alCENTER
+    uint8_t m_cur;      // cursor relative to the window
+    HdspUtf8 m_utf8;    // utf8 decoder of print(), independent of the driver
+
+  public:
+    // constructor, the window is limited to the displays of the driver
+    // @param drv   driver
+    // @param pos   first position of the window
+    // @param width number of chars of the window (0=up to the end)
+    // @param align alignment of WriteText(), alLEFT, alRIGHT or alCENTER
+    // @param name  name of the window
+    HdspWindow(Drv &drv, uint8_t pos, uint8_t width=0, uint8_t align=alLEFT,
+               const char *name="") {
+      uint8_t max = drv.GetDisplays() * nPOS;
+      m_drv   = &drv;
+      m_name  = name;
+      m_pos   = (pos<max) ? pos : max;
+      m_width = ((0==width) || (width>max-m_pos)) ? max-m_pos : width;
+      m_align = align;
+      m_cur   = 0;
+      m_utf8.SetFallback(drv.GetFallback());
+    }
+
+    // @return name of the window
+    inline const char *GetName(void) { return m_name; }
+
+    // @return first position of the window within the line
+    inline uint8_t GetStart(void) { return m_pos; }
+
+    // @return number of chars of the window
+    inline uint8_t GetWidth(void) { return m_width; }
+
+    // sets the alignment of WriteText()
+    // @param align alLEFT, alRIGHT or alCENTER
+    inline void SetAlign(uint8_t align) { m_align = align; }
+
+    // sets the cursor of print()
+    // @param cur position within the window, limited to the width
+    inline void SetCursor(uint8_t cur) { m_cur = (cur<m_width) ? cur : m_width; }
+
+    // @return cursor position within the window
+    inline uint8_t GetCursor(void) { return m_cur; }
+
+    // fills the window with blanks and sets the cursor to the start
+    inline void Clear(void) {
+      m_cur = 0;
+      m_drv->WriteField(m_pos,m_width,alLEFT,"");
+    }
+
+    // replaces the content of the window by a text printf() like, aligned
+    // within the window and padded with blanks
+    // @param format printf style format string
+    // @param ...    variable parameters
+    // @return number of chars of the text within the window
+    size_t WriteText(const char *format, ...) {
+      if(0==m_width) {
+        return 0;
+      }
+      uint8_t cur=m_drv->GetPos();
+      va_list args;
+      va_start(args, format);
+      size_t n=m_drv->WriteFieldV(m_pos,m_width,m_align,format,args);
+      va_end(args);
+      m_cur = m_drv->GetPos() - m_pos;   // behind the text
+      m_drv->SetPos(cur);                // keep the cursor of the driver
+      return n;
+    }
+
+    // virtual function of the Print class, writes a single char at the
+    // cursor of the window
+    // @param character single character
+    // @return number of characters written
+    virtual size_t write(const uint8_t character) {
+      return write(&character,1);
+    }
+
+    // virtual function of the Print class, writes the chars at the cursor
+    // of the window, chars behind the window are dropped
+    // @param buffer utf8 text
+    // @param size   number of bytes
+    // @return number of bytes
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+      bool af=m_drv->GetAutoFlush();
+      uint8_t cur=m_drv->GetPos();
+      bool upd=false;
+      for(size_t ic=0; ic<size; ic++) {
+        uint8_t ch = m_utf8.Feed(buffer[ic]);
+        if((0!=ch) && (m_cur<m_width)) {
+          if(!upd) {
+            m_drv->AutoFlush(0);         // collect all chars, single flush
+            upd=true;
+          }
+          m_drv->WriteChar(m_pos+m_cur++,ch);
+        }
+      }
+      if(upd) {
+        m_drv->SetPos(cur);              // keep the cursor of the driver
+        if(af) {
+          m_drv->AutoFlush(1);           // unchanged chars are not written
+        }
+      }
+      return size;
+    }
+
+    using Print::write;
+};
+
+#endif
+//__HDSP2112_WINDOW_H__
@@ -2,6 +2,11 @@
 
 #include "hdsp2112.h"
 #include "hdsp2112_udc_font.h"
+#include "hdsp2112_marquee.h"
+#include "hdsp2112_udc_cache.h"
+#include "hdsp2112_anim.h"
+#include "hdsp2112_window.h"
+#include "hdsp2112_frame.h"
 
 ///< user defined SPI interface, here ESP32 standard SPI interface (VSPI)
 constexpr int8_t s_cs   = 32;
@@ -10,6 +15,7 @@ constexpr int8_t s_mosi = 23;
 constexpr int8_t s_miso = 19;
 
 HDSP2112 d(s_cs,s_clk,s_mosi,s_miso); // create instance with user defined SPI
+HdspAnimator<HDSP2112> an(d);         // spinners, wipers, ...
 
 // reset and clear display, print title, and wait a second
 // @param title text to print
@@ -51,6 +57,35 @@ void testBrightness(void) {
   d.SetBrightness(4);
 }
 
+// Brightness fades, both displays in opposite directions
+void testFade(void) {
+  testTitle("testFade  <-->  ");
+  for(uint8_t ic=0; ic<4; ic++) {
+    d.Fade((ic&1) ? 0 : 7,1500,0b01);   // left display
+    d.Fade((ic&1) ? 7 : 0,1500,0b10);   // right display
+    while(d.Fading()) {
+      d.Service();                      // advances the fades
+      delay(5);                         // do something else
+    }
+  }
+  d.Fade(4,500);                        // back to default brightness
+  while(d.Fading()) {
+    d.Service();
+    delay(5);
+  }
+}
+
+// Frames, both displays change at the same time
+void testFrame(void) {
+  testTitle("testFrame       ");
+  HdspFrame<HDSP2112> fr(d);
+  for(uint16_t ic=0; ic<200; ic++) {
+    fr.WriteText(0,"%5u  %c%8.3f",ic,(ic&1) ? '*' : ' ',ic*0.125);
+    fr.Present();                       // all displays at once
+    delay(50);
+  }
+}
+
 // Flashing Mode, set flash bits at different positions
 void testFlashingText(void) {
   testTitle("1234flashing5678");
@@ -67,35 +102,30 @@ void testFlashingText(void) {
 // Blinking Mode, both display will blink synchronous
 void testBlinkingText(void) {
   testTitle("BlinkingText=OFF");
+  HdspWindow<HDSP2112> state(d,13,3); // "ON"/"OFF" field
   d.BlinkMode(0);
   delay(2500);
-  d.WriteText(13,"ON ");
+  state.WriteText("ON");
   d.BlinkMode(1);
   delay(5000);
   d.BlinkMode(0);
-  d.WriteText(13,"OFF");
+  state.WriteText("OFF");
   delay(2500);
   d.clear();
 }
 
-// call built-in self-test for both displays individually 
+// call built-in self-test for both displays at once, the display content 
+// is restored afterwards
 void doSelftest(void) {
-  uint8_t res=0; 
-  testTitle("self-test left  ");
-  d.clear();
-  d.WriteChar(10,tLeft);
-  d.WriteText(12,"Test");
-  res=d.Selftest(0); // self-test left display
-  d.WriteText(12,"%4s",((1==res)? "OK":"FAIL"));
-  delay(2000);  
-  testTitle("self-test right "); 
-  d.clear();
-  d.WriteText(0,"Test");
-  d.WriteChar(6,tRight);
-  res=d.Selftest(1); // self-test right display
-  d.WriteText(0,"%-4s",((1==res)? "OK":"FAIL"));
+  testTitle("self-test  L+R  ");
+  d.StartSelftest(0b11);      // self-test left and right display
+  while(d.SelftestBusy()) {
+    d.Service();              // poll self-test
+    delay(10);
+  }
+  uint16_t res=d.GetSelftestResult();
+  d.WriteText(0,"L=%-4s  R=%-4s",((res&1)? "OK":"FAIL"),((res&2)? "OK":"FAIL"));
   delay(2000);
-  d.Reset();         // after self-test a reset is needed
 }
 
 constexpr int32_t n_utf8=23;         // number of utf8 strings
@@ -120,36 +150,40 @@ void testUtf8String(void){
   delay(3000);
 }
 
+// scrolling text, longer than both displays, with a pause at both ends
+void testMarquee(void) {
+  testTitle("test marquee    ");
+  HdspMarquee<HDSP2112> mq(d);
+  mq.Start("+++ Grüße aus dem Labor: α=1.5 β=0.25 Δ=3µm, Ω=47k +++",8,1000);
+  uint32_t t0=millis();
+  while(millis()-t0 < 20000) {
+    mq.Tick();                      // scrolls, if a step is due
+    delay(5);                       // do something else
+  }
+  mq.Stop();
+  d.clear();
+}
+
 // propellors
 constexpr uint8_t prop0[4] ={'|','/','-','\\'};
-constexpr uint8_t prop1[8] ={128,129,130,131,132,133,134,135};
-constexpr uint8_t prop2[4] ={128,129,130,131};
+constexpr uint8_t prop1[8] ={cHand0,cHand1,cHand2,cHand3,cHand4,cHand5,cHand6,cHand7};
+constexpr uint8_t prop2[4] ={wDot0,wDot1,wDot2,wDot3};
 constexpr uint8_t prop3[4] ={aUp,aRight,aDown,aLeft};
-constexpr uint8_t prop4[8] ={139,140,141,142,143,142,141,140};
-constexpr uint8_t prop5[12]={132,133,134,135,136,137,138,137,136,135,134,133};
+constexpr uint8_t prop4[8] ={wRight0,wRight1,wRight2,wRight3,wRight4,wRight3,wRight2,wRight1};
+constexpr uint8_t prop5[12]={wDown0,wDown1,wDown2,wDown3,wDown4,wDown5,wDown6,
+                            wDown5,wDown4,wDown3,wDown2,wDown1};
 // wipers
-constexpr uint8_t wipe1[7]={132,133,134,135,136,137,138};
-constexpr uint8_t wipe0[5]={139,140,141,142,143};
+constexpr uint8_t wipe1[7]={wDown0,wDown1,wDown2,wDown3,wDown4,wDown5,wDown6};
+constexpr uint8_t wipe0[5]={wRight0,wRight1,wRight2,wRight3,wRight4};
+// heart beat, duration of each frame [ms]
+constexpr uint8_t  beat0[4]  ={cHeart,' ',cHeart,' '};
+constexpr uint16_t beatms[4] ={100,150,100,900};
 // arrows
 constexpr uint8_t arro0[3]={tLeft,tBar,tBar};
 constexpr uint8_t arro1[3]={tBar,tBar,tRight};
 constexpr uint8_t arro2[2]={aLeft,'-'};
 constexpr uint8_t arro3[2]={'-',aRight};
 
-// animated wipe out chars
-// @param alpha  character set for wipe animation
-// @param size   number of characters
-// @param speed  delay between char changes
-void wiper(const uint8_t *alpha, size_t size, uint8_t start, uint8_t end, uint32_t speed) {
-  for(uint8_t ic=start; ic<=end; ic++) {
-    for(uint8_t jc=0; jc<size; jc++) {
-      d.WriteChar(ic,alpha[jc]);
-      delay(speed);
-    }
-    d.WriteChar(ic,' ');
-  }
-}
-
 // draws an arrow
 // @param alpha character set for arrow
 // @param size  number of characters
@@ -163,27 +197,25 @@ void arrow(const uint8_t *alpha, size_t size, uint8_t pos, uint32_t del) {
   delay(del);
 }
 
-// animated propellor
-// @param alpha  character set for propellor
-// @param size   number of characters
-// @param pos    position within display
-// @param repeat number of repeats
-// @param speed  delay between char changes
-void prope(const uint8_t *alpha, size_t size, uint8_t pos, uint8_t repeat, uint32_t speed) {
-  for(uint8_t ic=0;ic<repeat;ic++) {
-    for(uint8_t jc=0;jc<size;jc++) {
-      d.WriteChar(pos,alpha[jc]); 
-      delay(speed);
-    }
+// runs the animations until all are done or the time is over
+// @param ms max. duration [ms]
+void animate(uint32_t ms) {
+  uint32_t t0=millis();
+  while(an.Busy() && (millis()-t0 < ms)) {
+    an.Tick();                      // all due frames in a single flush
+    delay(5);                       // do something else
   }
+  an.StopAll();
 }
 
 // user defined char font
 void testUDC(void){
   testTitle("UDC_font");
-  prope(prop0,sizeof(prop0),10,5,150);
-  prope(prop1,sizeof(prop1),10,5,150);
-  prope(prop3,sizeof(prop3),10,2,1000);
+  an.Start(9,prop0,sizeof(prop0),150,10);  // several animations at once
+  an.Start(11,prop1,sizeof(prop1),150,5);
+  an.Start(13,prop3,sizeof(prop3),1000,2);
+  an.Start(15,beat0,beatms,sizeof(beat0),5);
+  animate(10000);
   arrow(arro0,sizeof(arro0),10,2000);
   arrow(arro1,sizeof(arro1),10,2000);
   testTitle("UDC_font");
@@ -195,17 +227,40 @@ void testUDC(void){
 void testUDCwipe(void){
   d.SetUdcFont(UDC_wipe,UDC_nch);  // init wipe user defined characters
   testTitle("UDC_wipe        ");
-  prope(prop2,sizeof(prop2),10,8,250);
-  prope(prop4,sizeof(prop4),10,8,80);
-  prope(prop5,sizeof(prop5),10,8,80);
+  an.Start(10,prop2,sizeof(prop2),250,8);
+  an.Start(12,prop4,sizeof(prop4),80,25);
+  an.Start(14,prop5,sizeof(prop5),80,17);
+  animate(10000);
   d.clear(); 
   d.printf("TextTextTextText "); 
-  wiper(wipe0,sizeof(wipe0),0,15,50); 
+  for(uint8_t pos=0; pos<16; pos++) {      // wipe out char by char
+    an.Start(pos,wipe0,sizeof(wipe0),50,1,' ',pos*sizeof(wipe0)*50);
+  }
+  animate(10000);
   d.SetUdcFont(UDC_font,UDC_nch); // init standard user defined characters
 }
 
+// glyphs of both fonts mixed on the display, uploaded on demand without reset
+void testUdcCache(void){
+  testTitle("UDC cache       ");
+  HdspUdcCache<HDSP2112> udc(d,UDC_lib,UDC_nLib);
+  for(uint8_t ic=0; ic<64; ic++) {
+    d.AutoFlush(0);                 // uploads and chars in a single flush
+    d.WriteChar(11,udc.Glyph(UDC_idFont + (ic&7)));      // clock hands
+    d.WriteChar(13,udc.Glyph(UDC_idWipe + (ic&3)));      // animated dot
+    d.WriteChar(15,udc.Glyph(UDC_idWipe + 4 + (ic%7)));  // up-->down
+    d.AutoFlush(1);
+    delay(150);
+  }
+  d.SetUdcFont(UDC_font,UDC_nch);   // init standard user defined characters
+}
+
  void setup() {
+#ifdef HDSP2112_PROFILE
+  Serial.begin(115200);
+#else
   //Serial.begin(115200);
+#endif
   d.Begin();                        // does all the init stuff (SPI, MCP23s17, HDSP2112)
   d.SetUdcFont(UDC_font,UDC_nch);   // init user defined characters
   d.Reset();                        // reset display
@@ -216,10 +271,18 @@ void testUDCwipe(void){
 void loop() {
   testCharRam();
   testUtf8String();
+  testMarquee();
   testUDC();
   testUDCwipe();
+  testUdcCache();
   testFlashingText();
   testBlinkingText();
   testBrightness();
+  testFade();
+  testFrame();
   doSelftest();
+#ifdef HDSP2112_PROFILE
+  hdspProf.Dump(Serial);            // profile of a single demo loop
+  hdspProf.Clear();
+#endif
 }
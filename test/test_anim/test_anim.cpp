@@ -0,0 +1,65 @@
+// tests of the animation sequencer on the simulated hardware (pio test -e
+// native)
+
+#include <unity.h>
+#include "hdsp2112.h"
+#include "hdsp2112_anim.h"
+#include "hdsp2112_sim.h"
+
+constexpr int8_t tCS = 32;                // SPI chip-select of the displays
+
+static const uint8_t s_spin[4] = { '|', '/', '-', '\\' };
+
+// resets the simulated hardware and inits the driver
+// @param d driver
+static void begin(HDSP2112 &d) {
+  hdspSim.Begin();
+  d.Begin();
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+  TEST_ASSERT_EQUAL_UINT32(0, hdspSim.Violations());
+}
+
+// frames are shown with their duration, the end char after the last run
+void test_frames(void) {
+  HDSP2112 d(tCS);
+  begin(d);
+  HdspAnimator<HDSP2112> an(d);
+  uint8_t h = an.Start(3,s_spin,sizeof(s_spin),100,1,'*');
+  TEST_ASSERT_EQUAL_UINT8(1, an.Tick());
+  TEST_ASSERT_EQUAL_HEX8('|', hdspSim.Display(0).chr[3]);
+  delay(100);
+  an.Tick();
+  TEST_ASSERT_EQUAL_HEX8('/', hdspSim.Display(0).chr[3]);
+  delay(300);
+  an.Tick();
+  TEST_ASSERT_FALSE(an.Busy(h));
+  TEST_ASSERT_EQUAL_HEX8('*', hdspSim.Display(0).chr[3]);
+}
+
+// a duration of 0 is taken as 1ms, Tick() returns
+void test_zero_duration(void) {
+  HDSP2112 d(tCS);
+  begin(d);
+  HdspAnimator<HDSP2112> an(d);
+  static const uint16_t ms[4] = { 10, 0, 10, 0 };
+  uint8_t h0 = an.Start(0,s_spin,sizeof(s_spin),0);
+  uint8_t h1 = an.Start(1,s_spin,ms,sizeof(s_spin));
+  for(uint8_t it=0; it<8; it++) {
+    an.Tick();
+    delay(7);
+  }
+  TEST_ASSERT_TRUE(an.Busy(h0));
+  TEST_ASSERT_TRUE(an.Busy(h1));
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_frames);
+  RUN_TEST(test_zero_duration);
+  return UNITY_END();
+}
@@ -0,0 +1,146 @@
+// tests of the bus transactions per write cycle (pio test -e native). A
+// char costs trnWrData transactions, unchanged chars are not written. A
+// queued backend keeps the timing of the displays.
+
+#include <unity.h>
+#include <vector>
+#include "hdsp2112.h"
+#include "hdsp2112_sim.h"
+
+constexpr int8_t  tCS = 32;               // SPI chip-select of the displays
+constexpr uint8_t trnFL = 2;              // FL low and high around flash bits
+
+// host model of a queued backend like Mcp23s17DmaBus: the writes are sent
+// in order, but only by Commit(), Sync() and GetData()
+class QueuedBus : public Mcp23s17Bus {
+  private:
+    struct Op { uint8_t fn, a, b; };
+    std::vector<Op> m_q;       // writes not yet sent
+
+  public:
+    QueuedBus(int8_t cs) : Mcp23s17Bus(cs) {}
+    inline void SetCtrl(uint8_t c) { m_q.push_back({ 0, c, 0 }); }
+    inline void PulseCtrl(uint8_t c, uint8_t n) { m_q.push_back({ 1, c, n }); }
+    inline void SetAddr(uint8_t a) { m_q.push_back({ 2, a, 0 }); }
+    inline void SetData(uint8_t d) { m_q.push_back({ 3, d, 0 }); }
+    inline void SetAddrData(uint8_t a, uint8_t d) { m_q.push_back({ 4, a, d }); }
+    inline void DataDirection(uint8_t m) { m_q.push_back({ 5, m, 0 }); }
+    inline uint8_t GetData(void) { Sync(); return Mcp23s17Bus::GetData(); }
+    inline void Commit(void) { Sync(); }
+    inline bool Pending(void) { return !m_q.empty(); }
+    inline void Sync(void) {
+      for(const Op &o : m_q) {
+        switch(o.fn) {
+          case 0: Mcp23s17Bus::SetCtrl(o.a);          break;
+          case 1: Mcp23s17Bus::PulseCtrl(o.a,o.b);    break;
+          case 2: Mcp23s17Bus::SetAddr(o.a);          break;
+          case 3: Mcp23s17Bus::SetData(o.a);          break;
+          case 4: Mcp23s17Bus::SetAddrData(o.a,o.b);  break;
+          case 5: Mcp23s17Bus::DataDirection(o.a);    break;
+        }
+      }
+      m_q.clear();
+    }
+};
+
+// resets the simulated hardware and inits the driver
+// @param d driver
+static void begin(HDSP2112 &d) {
+  hdspSim.Begin();
+  d.Begin();
+  d.ClearTransactions();
+  hdspSim.ClearLog();                 // transactions of the test only
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+  TEST_ASSERT_EQUAL_UINT32(0, hdspSim.Violations());
+}
+
+// single chars, each call writes one char
+void test_write_char(void) {
+  HDSP2112 d(tCS);
+  begin(d);
+  const char *txt = "ABCDEFGHIJ";
+  uint32_t n = strlen(txt);
+  for(uint8_t pos=0; pos<n; pos++) {
+    d.WriteChar(pos,txt[pos]);
+  }
+  TEST_ASSERT_EQUAL_UINT32(n*trnWrData, d.GetTransactions());
+  TEST_ASSERT_EQUAL_UINT32(n*trnWrData, hdspSim.Log().size());
+}
+
+// a text is written as a burst per display, still trnWrData per char
+void test_write_text(void) {
+  HDSP2112 d(tCS);
+  begin(d);
+  uint32_t n = d.WriteText(0,"%s","0123456789ABCDEF");
+  TEST_ASSERT_EQUAL_UINT32(16, n);
+  TEST_ASSERT_EQUAL_UINT32(n*trnWrData, d.GetTransactions());
+  d.ClearTransactions();
+  d.WriteText(2,"%s","xyz");          // 3 changed chars
+  TEST_ASSERT_EQUAL_UINT32(3*trnWrData, d.GetTransactions());
+}
+
+// flash bits cost trnWrData per bit plus FL low and high
+void test_flash_bits(void) {
+  HDSP2112 d(tCS);
+  begin(d);
+  d.SetFlashBits(0xf0000000);         // 4 bits of display 0
+  TEST_ASSERT_EQUAL_UINT32(4*trnWrData + trnFL, d.GetTransactions());
+}
+
+// unchanged chars, flash bits and control-words cost nothing
+void test_unchanged(void) {
+  HDSP2112 d(tCS);
+  begin(d);
+  d.WriteText(0,"%s","0123456789ABCDEF");
+  d.SetFlashBits(0x0f000000);
+  d.SetBrightness(2);
+  d.ClearTransactions();
+  hdspSim.ClearLog();
+  d.WriteText(0,"%s","0123456789ABCDEF");
+  d.WriteChar(5,'5');
+  d.SetFlashBits(0x0f000000);
+  d.SetBrightness(2);
+  d.Flush();
+  TEST_ASSERT_EQUAL_UINT32(0, d.GetTransactions());
+  TEST_ASSERT_EQUAL_UINT32(0, hdspSim.Log().size());
+}
+
+// with a queued backend the delays of the driver (reset, clear, read runs,
+// self test) are still counted from the bus, every call ends with an
+// empty queue
+void test_queued(void) {
+  QueuedBus bus(tCS);
+  hdspSim.Begin();
+  HDSP2112T<QueuedBus> d(&bus);
+  d.Begin();
+  d.WriteText(0,"%s","0123456789ABCDEF");
+  d.SetFlashBits(0x0f0f0000);
+  TEST_ASSERT_FALSE(bus.Pending());
+  TEST_ASSERT_EQUAL_HEX8(0xf0, hdspSim.Display(0).flash);
+  d.SetScrub(1);
+  hdspSim.Display(0).chr[2] = '?';    // corrupted cell, 1st run
+  delay(2);
+  d.Service();
+  TEST_ASSERT_EQUAL_UINT32(1, d.GetScrubFixed());
+  TEST_ASSERT_EQUAL_UINT8(1, d.Selftest(1));
+  TEST_ASSERT_FALSE(bus.Pending());
+  TEST_ASSERT_EQUAL_STRING("0123456789ABCDEF", hdspSim.Text(2).c_str());
+  d.clear();
+  TEST_ASSERT_FALSE(bus.Pending());
+  TEST_ASSERT_EQUAL_STRING("                ", hdspSim.Text(2).c_str());
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_write_char);
+  RUN_TEST(test_write_text);
+  RUN_TEST(test_flash_bits);
+  RUN_TEST(test_unchanged);
+  RUN_TEST(test_queued);
+  return UNITY_END();
+}
@@ -0,0 +1,450 @@
+// tests of the driver on the simulated hardware (pio test -e native). The
+// simulator decodes the bus signals into the registers of each hdsp2112,
+// so the tests check the content of the displays after a call instead of
+// the calls to the bus. The regression tests limit the bus transactions
+// and the latency of fixed workloads, the limits are the values of the
+// current bus path, i.e. a slower path fails the test.
+
+#include <unity.h>
+#include "hdsp2112.h"
+#include "hdsp2112_udc_font.h"
+#include "hdsp2112_udc_cache.h"
+#include "hdsp2112_frame.h"
+#include "hdsp2112_sim.h"
+
+constexpr int8_t tCS = 32;                // SPI chip-select of the displays
+
+// upper limits of the regression tests
+constexpr uint32_t trnLINE  = 32;         // 16 changed chars
+constexpr uint32_t trnCLEAR = 4;          // clear() of a filled line
+constexpr uint32_t trnFONT  = 276;        // SetUdcFont() of 16 chars
+constexpr uint32_t trnFLASH = 34;         // 16 changed flash bits
+constexpr uint32_t usLINE   = 208;        // latency of 16 chars in async mode
+
+// 16 chars, which differ at every position from the blank line
+static const char *s_line = "0123456789ABCDEF";
+
+// resets the simulated hardware and inits the driver
+// @param d driver
+static void begin(HDSP2112 &d) {
+  hdspSim.Begin();
+  d.Begin();
+  d.ClearTransactions();
+}
+
+// checks the char-RAM of all displays against the shadow ram
+// @param d driver
+static void checkChars(HDSP2112 &d) {
+  for(uint8_t pos=0; pos<d.GetDisplays()*nPOS; pos++) {
+    TEST_ASSERT_EQUAL_HEX8(d.GetChar(pos), hdspSim.Display(pos/nPOS).chr[pos%nPOS]);
+  }
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+  TEST_ASSERT_EQUAL_UINT32(0, hdspSim.Violations());
+}
+
+// chars are written at once with AutoFlush(1)
+void test_chars(void) {
+  HDSP2112 d(tCS);
+  begin(d);
+  d.WriteText(3,"HDSP");
+  d.WriteChar(12,'x');
+  TEST_ASSERT_EQUAL_STRING("   HDSP     x   ", hdspSim.Text(2).c_str());
+  checkChars(d);
+}
+
+// with AutoFlush(0) only the shadow ram changes until Flush()
+void test_flush(void) {
+  HDSP2112 d(tCS);
+  begin(d);
+  d.AutoFlush(0);
+  d.WriteText(0,"%s",s_line);
+  TEST_ASSERT_EQUAL_STRING("                ", hdspSim.Text(2).c_str());
+  TEST_ASSERT_EQUAL_UINT32(0, d.GetTransactions());
+  d.Flush();
+  TEST_ASSERT_EQUAL_STRING(s_line, hdspSim.Text(2).c_str());
+  checkChars(d);
+  d.AutoFlush(1);
+}
+
+// flash bits, MSB=leftmost char, bit[n] of a display = position n
+void test_flash(void) {
+  HDSP2112 d(tCS);
+  begin(d);
+  d.SetFlashBits(0xc0810000);
+  TEST_ASSERT_EQUAL_HEX8(0x03, hdspSim.Display(0).flash);
+  TEST_ASSERT_EQUAL_HEX8(0x81, hdspSim.Display(1).flash);
+  d.SetFlashBits(0x00010000);
+  TEST_ASSERT_EQUAL_HEX8(0x00, hdspSim.Display(0).flash);
+  TEST_ASSERT_EQUAL_HEX8(0x80, hdspSim.Display(1).flash);
+}
+
+// control-words of all displays and of a group of displays
+void test_cwr(void) {
+  HDSP2112 d(tCS);
+  begin(d);
+  d.SetBrightness(3);
+  d.BlinkMode(1,0b10);
+  d.FlashMode(1,0b01);
+  TEST_ASSERT_EQUAL_HEX8(3|cwrFLASH, hdspSim.Display(0).cwr & ~cwrTSTOK);
+  TEST_ASSERT_EQUAL_HEX8(3|cwrBLINK, hdspSim.Display(1).cwr & ~cwrTSTOK);
+  TEST_ASSERT_EQUAL_HEX8(d.GetCwr(0), hdspSim.Display(0).cwr & ~cwrTSTOK);
+  TEST_ASSERT_EQUAL_HEX8(d.GetCwr(1), hdspSim.Display(1).cwr & ~cwrTSTOK);
+}
+
+// user defined chars of a font and a single user defined char, the fonts
+// are arrays with the rows of the library
+void test_udc(void) {
+  HDSP2112 d(tCS);
+  begin(d);
+  TEST_ASSERT_EQUAL_UINT32(UDC_size, sizeof(UDC_font));
+  TEST_ASSERT_EQUAL_UINT32(UDC_size, sizeof(UDC_wipe));
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(UDC_lib+UDC_idFont*UDC_rows, UDC_font, UDC_size);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(UDC_lib+UDC_idWipe*UDC_rows, UDC_wipe, UDC_size);
+  d.SetUdcFont(UDC_font,UDC_nch);
+  d.SetUdChar(UDC_wipe,3);
+  for(uint8_t hid=0; hid<d.GetDisplays(); hid++) {
+    for(uint8_t ic=0; ic<UDC_nch; ic++) {
+      const uint8_t *map = (3==ic) ? UDC_wipe : UDC_font+ic*UDC_rows;
+      TEST_ASSERT_EQUAL_HEX8_ARRAY(map, hdspSim.Display(hid).udc[ic], UDC_rows);
+    }
+  }
+}
+
+// the udc cache replaces the least recently used slot, which is not shown,
+// and writes only the rows which differ from the old glyph
+void test_udc_cache(void) {
+  HDSP2112 d(tCS);
+  begin(d);
+  HdspUdcCache<HDSP2112> udc(d,UDC_lib,UDC_nLib,0,2); // 2 slots
+  const uint16_t down0 = UDC_idWipe+4; // wDown0..2, one row each
+  TEST_ASSERT_EQUAL_HEX8(128, udc.Glyph(down0));
+  TEST_ASSERT_EQUAL_HEX8(129, udc.Glyph(down0+1));
+  d.WriteChar(0,129);                  // slot 1 is shown
+  TEST_ASSERT_EQUAL_HEX8(128, udc.Glyph(down0));
+  TEST_ASSERT_EQUAL_UINT32(1, udc.GetHits());
+  d.ClearTransactions();
+  TEST_ASSERT_EQUAL_HEX8(128, udc.Glyph(down0+2)); // slot 0, 1 is shown
+  TEST_ASSERT_EQUAL_UINT32(3, udc.GetUploads());
+  // UDC address and the 2 rows which differ, all displays at once
+  TEST_ASSERT_EQUAL_UINT32(3*trnWrData, d.GetTransactions());
+  for(uint8_t hid=0; hid<d.GetDisplays(); hid++) {
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(UDC_lib+(down0+2)*UDC_rows, hdspSim.Display(hid).udc[0], UDC_rows);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(UDC_lib+(down0+1)*UDC_rows, hdspSim.Display(hid).udc[1], UDC_rows);
+  }
+  TEST_ASSERT_EQUAL_HEX8(129, hdspSim.Display(0).chr[0]);
+  d.WriteChar(1,128);                  // both slots shown, no slot left
+  TEST_ASSERT_EQUAL_HEX8(0, udc.Glyph(down0+3));
+}
+
+// the scrub reads back one display per run and rewrites the corrupted
+// cells only, a run waits for unflushed changes
+void test_scrub(void) {
+  HDSP2112 d(tCS);
+  begin(d);
+  d.WriteText(0,"%s",s_line);
+  d.SetBrightness(2);
+  d.SetScrub(10);
+  hdspSim.Display(0).chr[5] = '?';     // noise on the bus
+  hdspSim.Display(1).cwr = 6;
+  delay(10);
+  d.Service();                         // display 0
+  TEST_ASSERT_EQUAL_UINT32(1, d.GetScrubRuns());
+  TEST_ASSERT_EQUAL_UINT32(1, d.GetScrubFixed());
+  TEST_ASSERT_EQUAL_HEX8('5', hdspSim.Display(0).chr[5]);
+  TEST_ASSERT_EQUAL_HEX8(6, hdspSim.Display(1).cwr & cwrBRIGHT);
+  d.Service();                         // period not yet over
+  TEST_ASSERT_EQUAL_UINT32(1, d.GetScrubRuns());
+  d.AutoFlush(0);
+  d.WriteChar(0,'x');                  // not yet flushed
+  delay(10);
+  d.Service();
+  TEST_ASSERT_EQUAL_UINT32(1, d.GetScrubRuns());
+  d.AutoFlush(1);
+  delay(10);
+  d.Service();                         // display 1
+  TEST_ASSERT_EQUAL_UINT32(2, d.GetScrubRuns());
+  TEST_ASSERT_EQUAL_UINT32(2, d.GetScrubFixed());
+  TEST_ASSERT_EQUAL_HEX8(2, hdspSim.Display(1).cwr & cwrBRIGHT);
+  TEST_ASSERT_EQUAL_STRING("x123456789ABCDEF", hdspSim.Text(2).c_str());
+}
+
+// a frame is drawn without bus access, Present() writes all displays in
+// one pass, equal chars of several displays by a single cycle
+void test_frame(void) {
+  HDSP2112 d(tCS,SPI_clk,SPI_mosi,SPI_miso,4);
+  begin(d);
+  HdspFrame<HDSP2112> fr(d);
+  const char *line = "ABCDEFGHABCDEFGHABCDEFGHABCDEFGH";
+  fr.WriteText(0,"%s",line);
+  TEST_ASSERT_EQUAL_UINT32(0, d.GetTransactions());
+  fr.Present();                        // a cycle per position, all displays
+  TEST_ASSERT_EQUAL_STRING(line, hdspSim.Text(4).c_str());
+  TEST_ASSERT_EQUAL_UINT32(nPOS*trnWrData, d.GetTransactions());
+  d.ClearTransactions();
+  fr.WriteChar(3,'x');                 // displays 0 and 1 share 'x'
+  fr.WriteChar(11,'x');
+  fr.WriteChar(30,'y');
+  fr.Present();
+  TEST_ASSERT_EQUAL_STRING("ABCxEFGHABCxEFGHABCDEFGHABCDEFyH", hdspSim.Text(4).c_str());
+  TEST_ASSERT_EQUAL_UINT32(2*trnWrData, d.GetTransactions());
+  d.ClearTransactions();
+  fr.Present();                        // unchanged
+  TEST_ASSERT_EQUAL_UINT32(0, d.GetTransactions());
+  d.WriteChar(20,'?');                 // changed by the driver in between
+  fr.Present();
+  TEST_ASSERT_EQUAL_HEX8('E', hdspSim.Display(2).chr[4]);
+  TEST_ASSERT_TRUE(d.GetAutoFlush());
+  checkChars(d);
+}
+
+// clear() blanks the chars and flash bits of all displays
+void test_clear(void) {
+  HDSP2112 d(tCS);
+  begin(d);
+  d.WriteText(0,"%s",s_line);
+  d.SetFlashBits(0xffff0000);
+  d.clear();
+  TEST_ASSERT_EQUAL_STRING("                ", hdspSim.Text(2).c_str());
+  TEST_ASSERT_EQUAL_HEX8(0, hdspSim.Display(0).flash);
+  TEST_ASSERT_EQUAL_HEX8(0, hdspSim.Display(1).flash);
+  TEST_ASSERT_EQUAL_UINT8(0, d.GetPos());
+  checkChars(d);
+  d.WriteText(0,"%s",s_line);          // with AutoFlush(0) at the next Flush()
+  d.SetFlashBits(0x00ff0000);
+  d.AutoFlush(0);
+  d.clear();
+  TEST_ASSERT_EQUAL_HEX8(0xff, hdspSim.Display(1).flash);
+  d.Flush();
+  d.AutoFlush(1);
+  TEST_ASSERT_EQUAL_STRING("                ", hdspSim.Text(2).c_str());
+  TEST_ASSERT_EQUAL_HEX8(0, hdspSim.Display(1).flash);
+  checkChars(d);
+}
+
+// clear() during a self test blanks the display under test afterwards
+void test_clear_selftest(void) {
+  HDSP2112 d(tCS);
+  begin(d);
+  d.WriteText(0,"%s",s_line);
+  d.SetFlashBits(0xf00f0000);
+  TEST_ASSERT_TRUE(d.StartSelftest(0x0001));
+  d.clear();
+  while(d.SelftestBusy()) {
+    delay(10);
+    d.Service();
+  }
+  TEST_ASSERT_EQUAL_STRING("                ", hdspSim.Text(2).c_str());
+  TEST_ASSERT_EQUAL_HEX8(0, hdspSim.Display(0).flash);
+  TEST_ASSERT_EQUAL_HEX8(0, hdspSim.Display(1).flash);
+}
+
+// regression: bus transactions of fixed workloads
+void test_transactions(void) {
+  HDSP2112 d(tCS);
+  begin(d);
+  d.WriteText(0,"%s",s_line);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(trnLINE, d.GetTransactions());
+  d.ClearTransactions();
+  d.SetFlashBits(0xffff0000);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(trnFLASH, d.GetTransactions());
+  d.ClearTransactions();
+  d.clear();
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(trnCLEAR, d.GetTransactions());
+  d.ClearTransactions();
+  d.SetUdcFont(UDC_font,UDC_nch);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(trnFONT, d.GetTransactions());
+}
+
+// regression: latency from posting a line until it is written in async mode
+void test_latency(void) {
+  HDSP2112 d(tCS);
+  begin(d);
+  d.Async(1);
+  d.WriteText(0,"%s",s_line);
+  d.Service();
+  d.Async(0);
+  TEST_ASSERT_EQUAL_STRING(s_line, hdspSim.Text(2).c_str());
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(usLINE, d.GetMaxLatency());
+}
+
+// blocking self test in async mode without render task
+void test_selftest_async(void) {
+  HDSP2112 d(tCS);
+  begin(d);
+  d.WriteText(0,"%s",s_line);
+  d.Async(1);
+  TEST_ASSERT_EQUAL_UINT8(1, d.Selftest(0));
+  d.Async(0);
+  TEST_ASSERT_FALSE(d.SelftestBusy());
+  TEST_ASSERT_EQUAL_STRING(s_line, hdspSim.Text(2).c_str());
+}
+
+// GetChar() returns the posted chars in async mode, before Service()
+void test_getchar_async(void) {
+  HDSP2112 d(tCS);
+  begin(d);
+  d.Async(1);
+  d.WriteText(0,"%s",s_line);
+  for(uint8_t pos=0; pos<16; pos++) {
+    TEST_ASSERT_EQUAL_HEX8(s_line[pos], d.GetChar(pos));
+  }
+  d.clear();
+  TEST_ASSERT_EQUAL_HEX8(' ', d.GetChar(0));
+  d.Service();
+  d.Async(0);
+  checkChars(d);
+}
+
+// two chains of 4 displays at the same SPI chip-select (HAEN addresses),
+// display hid is at chain hid/4 and CS[hid%4], broadcasts reach both chains
+void test_chains(void) {
+  static const uint8_t a1[2] = { U1_addr, 2 }; // U1 of chain 0 and 1
+  Mcp23s17Bus b0(tCS);
+  Mcp23s17Bus b1(tCS,SPI_clk,SPI_mosi,SPI_miso,a1[1],6);
+  Mcp23s17Bus *bus[2] = { &b0, &b1 };
+  hdspSim.Begin();
+  hdspSim.Attach(tCS,a1[1],6);
+  HDSP2112 d(bus,2,8);
+  d.Begin();
+  const char *line = "ABCDEFGHIJKLMNOPQRSTUVWXYZ012345abcdefghijklmnopqrstuvwxyz6789";
+  d.WriteText(0,"%s",line);
+  d.WriteChar(40,'x');                 // display 5 = chain 1 at CS1
+  TEST_ASSERT_EQUAL_STRING("ABCDEFGHIJKLMNOPQRSTUVWXYZ012345", hdspSim.Text(4,tCS,a1[0]).c_str());
+  TEST_ASSERT_EQUAL_STRING("abcdefghxjklmnopqrstuvwxyz6789  ", hdspSim.Text(4,tCS,a1[1]).c_str());
+  static const uint8_t fb[8] = { 0x81, 0x18, 0xff, 0x00, 0x42, 0x24, 0x3c, 0xc3 };
+  d.SetFlashBits(fb,8);                // bytes symmetric, MSB=position 0
+  d.SetBrightness(3);                  // WrGroup of all displays
+  d.SetBrightness(5,0x0030);           // displays 4 and 5 only
+  for(uint8_t hid=0; hid<8; hid++) {
+    SimDisplay &s = hdspSim.Display(hid%4,tCS,a1[hid/4]);
+    TEST_ASSERT_EQUAL_HEX8(fb[hid], s.flash);
+    TEST_ASSERT_EQUAL_HEX8((0x30 & (1u<<hid)) ? 5 : 3, s.cwr & ~cwrTSTOK);
+  }
+  d.SetUdcFont(UDC_font,UDC_nch);      // broadcast by flushUdc()
+  d.WriteText(0,"%s",line);
+  d.clear();                           // cwrCLEAR of all displays
+  for(uint8_t hid=0; hid<8; hid++) {
+    SimDisplay &s = hdspSim.Display(hid%4,tCS,a1[hid/4]);
+    for(uint8_t ic=0; ic<UDC_nch; ic++) {
+      TEST_ASSERT_EQUAL_HEX8_ARRAY(UDC_font+ic*UDC_rows, s.udc[ic], UDC_rows);
+    }
+    TEST_ASSERT_EQUAL_HEX8(0, s.flash);
+  }
+  TEST_ASSERT_EQUAL_STRING("                                ", hdspSim.Text(4,tCS,a1[0]).c_str());
+  TEST_ASSERT_EQUAL_STRING("                                ", hdspSim.Text(4,tCS,a1[1]).c_str());
+  checkChars(d);
+}
+
+// SetBrightness() during a fade stops the fade of its displays, the level
+// is kept by the next Service()
+void test_fade_brightness(void) {
+  HDSP2112 d(tCS);
+  begin(d);
+  d.Fade(7,1000);
+  delay(300);
+  d.Service();
+  d.SetBrightness(2,0x0001);           // display 0 only
+  TEST_ASSERT_TRUE(d.Fading());        // display 1 is still fading
+  delay(300);
+  d.Service();
+  TEST_ASSERT_EQUAL_HEX8(2, hdspSim.Display(0).cwr & cwrBRIGHT);
+  d.SetBrightness(1);
+  TEST_ASSERT_FALSE(d.Fading());
+  d.Async(1);                          // the same posted to Service()
+  d.Fade(7,1000);
+  d.Service();
+  delay(300);
+  d.SetBrightness(3);
+  d.Service();
+  TEST_ASSERT_FALSE(d.Fading());
+  delay(300);
+  d.Service();
+  d.Async(0);
+  TEST_ASSERT_EQUAL_HEX8(3, hdspSim.Display(0).cwr & cwrBRIGHT);
+  TEST_ASSERT_EQUAL_HEX8(3, hdspSim.Display(1).cwr & cwrBRIGHT);
+}
+
+// async WriteText() of whole lines on a panel of maxDSP displays, the
+// chars of a line cost a single entry of the queue
+void test_async_panel(void) {
+  static const int8_t cs[maxCHN] = { tCS, 33, 25, 26 };
+  Mcp23s17Bus *bus[maxCHN];
+  for(uint8_t ic=0; ic<maxCHN; ic++) {
+    bus[ic] = new Mcp23s17Bus(cs[ic]);
+  }
+  hdspSim.Begin();
+  HDSP2112 d(bus,maxCHN,maxDSP);
+  d.Begin();
+  d.Async(1);
+  char line[maxCHR+1];
+  for(uint8_t il=0; il<4; il++) {    // back-to-back lines
+    for(uint8_t ic=0; ic<maxCHR; ic++) {
+      line[ic] = 'A' + (ic+il)%26;
+    }
+    line[maxCHR] = '\0';
+    TEST_ASSERT_EQUAL_UINT32(maxCHR, d.WriteText(0,"%s",line));
+  }
+  d.Service();
+  d.Async(0);
+  TEST_ASSERT_EQUAL_UINT32(0, d.GetOverflows());
+  for(uint8_t ic=0; ic<maxCHN; ic++) {
+    std::string exp(line+ic*nCHNDSP*nPOS,nCHNDSP*nPOS);
+    TEST_ASSERT_EQUAL_STRING(exp.c_str(), hdspSim.Text(nCHNDSP,cs[ic]).c_str());
+  }
+  for(uint8_t ic=0; ic<maxCHN; ic++) {
+    delete bus[ic];
+  }
+}
+
+// fades lost by a full queue are not waited for, Reset() aborts all fades
+void test_fade_overflow(void) {
+  HDSP2112 d(tCS);
+  begin(d);
+  d.Async(1);
+  for(uint8_t il=0; il<nQUEUE+16; il++) {
+    d.Fade(il&7,10);
+  }
+  TEST_ASSERT_EQUAL_UINT32(16, d.GetOverflows());
+  for(uint8_t il=0; (il<100) && d.Fading(); il++) {
+    d.Service();
+    delay(5);
+  }
+  TEST_ASSERT_FALSE(d.Fading());
+  d.Fade(7,1000);
+  d.Reset();
+  d.Service();
+  TEST_ASSERT_FALSE(d.Fading());
+  d.Async(0);
+  d.Fade(0,1000);
+  TEST_ASSERT_TRUE(d.Fading());
+  d.Reset();
+  TEST_ASSERT_FALSE(d.Fading());
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_chars);
+  RUN_TEST(test_flush);
+  RUN_TEST(test_flash);
+  RUN_TEST(test_cwr);
+  RUN_TEST(test_udc);
+  RUN_TEST(test_udc_cache);
+  RUN_TEST(test_frame);
+  RUN_TEST(test_clear);
+  RUN_TEST(test_clear_selftest);
+  RUN_TEST(test_scrub);
+  RUN_TEST(test_transactions);
+  RUN_TEST(test_latency);
+  RUN_TEST(test_selftest_async);
+  RUN_TEST(test_getchar_async);
+  RUN_TEST(test_chains);
+  RUN_TEST(test_async_panel);
+  RUN_TEST(test_fade_overflow);
+  RUN_TEST(test_fade_brightness);
+  return UNITY_END();
+}
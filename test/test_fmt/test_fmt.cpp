@@ -0,0 +1,156 @@
+// tests of the printf style formatter hdspFormat() (pio test -e native).
+// The output is compared with snprintf() of the host, table by table for
+// each type of the argument, up to the longest line (maxCHR chars). The
+// driver tests check utf8 text and the cut at the end of a window.
+
+#include <unity.h>
+#include <math.h>
+#include <string>
+#include "hdsp2112.h"
+#include "hdsp2112_sim.h"
+
+constexpr int8_t tCS = 32;                // SPI chip-select of the displays
+
+// sink of hdspFormat(), collects the bytes
+class StrSink {
+  public:
+    std::string m_s;
+    inline void Put(char c) { m_s += c; }
+};
+
+// formats a text by hdspFormat() and by snprintf() and compares both up
+// to the longest line
+// @param format printf style format string
+// @param ...    variable parameters
+static void check(const char *format, ...) {
+  StrSink out;
+  char ref[512];
+  va_list args, cp;
+  va_start(args, format);
+  va_copy(cp, args);
+  hdspFormat(out,format,args);
+  vsnprintf(ref,sizeof(ref),format,cp);
+  va_end(cp);
+  va_end(args);
+  std::string exp(ref);
+  TEST_ASSERT_EQUAL_STRING_MESSAGE(exp.substr(0,maxCHR).c_str(),
+                                   out.m_s.substr(0,maxCHR).c_str(), format);
+}
+
+struct FmtInt { const char *f; long long v; };
+struct FmtDbl { const char *f; double v; };
+struct FmtStr { const char *f; const char *v; };
+
+static const FmtInt s_int[] = {
+  { "%d", 0 }, { "%d", -42 }, { "%i", 12345 }, { "%5d", 42 }, { "%-5d|", 42 },
+  { "%05d", -42 }, { "%+d", 7 }, { "% d", 7 }, { "%.3d", 5 }, { "%08.3d", 5 },
+  { "%-08.3d|", -5 }, { "%x", 0xbeef }, { "%#X", 0xbeef }, { "%#010x", 0x1f },
+  { "%o", 8 }, { "%#o", 8 }, { "%u", 4000000000ll }, { "%hhd", 300 },
+  { "%hd", 70000 }, { "%ld", -2000000000l }, { "%lld", -9000000000000ll },
+  { "%llx", 0x123456789abll }, { "%40d", -123 }, { "%-40d|", 123 },
+  { "%040d", -123 }, { "%040.5d", -123 }, { "%#0140x", 0xabc },
+  { "%.140d", 77 }, { "%200d", 1 }, { "[%c]", 'x' }, { "[%5c]", 'x' },
+  { "[%-5c]", 'x' }, { "%%%d%%", 5 },
+};
+
+static const FmtDbl s_dbl[] = {
+  { "%f", 3.14159 }, { "%.2f", -2.005 }, { "%8.3f", 1.5 }, { "%-8.3f|", 1.5 },
+  { "%08.3f", -1.5 }, { "%+.1f", 2.25 }, { "%e", 12345.678 },
+  { "%.3E", 0.000123 }, { "%g", 0.0001 }, { "%G", 1e20 }, { "%#g", 1.0 },
+  { "%a", 1.0 }, { "%f", 1e30 }, { "%.60f", 1.0/3 }, { "%.140f", 2.5 },
+  { "%050.3f", -3.25 }, { "%-050.3f|", 3.25 }, { "%0100.2f", 1e40 },
+  { "%040a", -1.5 }, { "%040f", INFINITY }, { "%040f", -INFINITY },
+  { "%-40f|", NAN }, { "%f", -0.0 },
+};
+
+static const FmtStr s_str[] = {
+  { "%s", "abc" }, { "[%8s]", "abc" }, { "[%-8s]", "abc" }, { "[%.2s]", "abc" },
+  { "[%8.2s]", "abc" }, { "[%40s]", "abc" }, { "[%s]", "" },
+  { "%s", "0123456789012345678901234567890123456789" },
+};
+
+// integers, chars, flags, widths and precisions
+void test_int(void) {
+  for(size_t it=0; it<sizeof(s_int)/sizeof(s_int[0]); it++) {
+    const char *f = s_int[it].f;
+    if(strstr(f,"ll")) {
+      check(f,s_int[it].v);
+    } else if(strchr(f,'l')) {
+      check(f,(long)s_int[it].v);
+    } else {
+      check(f,(int)s_int[it].v);
+    }
+  }
+}
+
+// floating point, also longer than the scratch and inf, nan
+void test_double(void) {
+  for(size_t it=0; it<sizeof(s_dbl)/sizeof(s_dbl[0]); it++) {
+    check(s_dbl[it].f,s_dbl[it].v);
+  }
+}
+
+// strings
+void test_string(void) {
+  for(size_t it=0; it<sizeof(s_str)/sizeof(s_str[0]); it++) {
+    check(s_str[it].f,s_str[it].v);
+  }
+}
+
+// width and precision as parameters, several conversions
+void test_star(void) {
+  check("%*d|%-*d|",6,42,-6,42);
+  check("%.*f %*.*f",2,3.14159,10,3,2.71828);
+  check("%*d|",-40,9);
+  check("%s=%5.1f%c",(const char*)"T",21.55,'C');
+}
+
+// the width of %s counts utf8 chars, text behind the window is cut
+void test_window(void) {
+  hdspSim.Begin();
+  HDSP2112 d(tCS);
+  d.Begin();
+  HdspUtf8 u;
+  uint8_t ae = 0;                      // char of "ä"
+  for(const char *c = "\xc3\xa4"; '\0'!=*c; c++) {
+    ae = u.Feed((uint8_t)*c);
+  }
+  TEST_ASSERT_EQUAL_UINT32(3, d.WriteField(0,6,alRIGHT,"%s","\xc3\xa4x\xc3\xa4"));
+  const uint8_t exp[6] = { ' ', ' ', ' ', ae, 'x', ae };
+  for(uint8_t pos=0; pos<6; pos++) {
+    TEST_ASSERT_EQUAL_HEX8(exp[pos], d.GetChar(pos));
+  }
+  TEST_ASSERT_EQUAL_UINT32(4, d.WriteField(12,4,alLEFT,"%5s|","abcdefg"));
+  TEST_ASSERT_EQUAL_STRING("   .x.      abcd", hdspSim.Text(2).c_str());
+  TEST_ASSERT_EQUAL_UINT32(0, hdspSim.Violations());
+}
+
+// WriteText() behind the line and after an incomplete utf8 sequence
+void test_write_text(void) {
+  hdspSim.Begin();
+  HDSP2112 d(tCS);
+  d.Begin();
+  TEST_ASSERT_EQUAL_UINT32(1, d.WriteText(20,"AB"));  // limited to pos 15
+  TEST_ASSERT_EQUAL_HEX8('A', d.GetChar(15));
+  d.print("\xc3");                     // first byte of a sequence only
+  TEST_ASSERT_EQUAL_UINT32(2, d.WriteText(0,"%d",42));
+  TEST_ASSERT_EQUAL_HEX8('4', d.GetChar(0));
+  TEST_ASSERT_EQUAL_HEX8('2', d.GetChar(1));
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_int);
+  RUN_TEST(test_double);
+  RUN_TEST(test_string);
+  RUN_TEST(test_star);
+  RUN_TEST(test_window);
+  RUN_TEST(test_write_text);
+  return UNITY_END();
+}
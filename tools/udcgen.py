@@ -0,0 +1,392 @@
+#!/usr/bin/env python3
+# glyph compiler of the hdsp2112 driver. Reads the glyph definitions of the
+# user defined chars (font/hdsp2112_udc.txt, optionally BDF fonts) and the
+# code points of the built-in character set (font/hdsp2112_charset.txt) and
+# writes the constexpr tables
+#
+#   src/hdsp2112_udc_font.h   rows of all glyphs, fonts, char constants and
+#                             a hash of each glyph
+#   src/hdsp2112_utf8_map.h   code point --> char, perfect hash table
+#
+# PlatformIO runs it before each build (extra_scripts), a header is only
+# written if its content changes. Without PlatformIO:
+#
+#   python tools/udcgen.py [project dir]
+
+import os
+import re
+import sys
+
+NCH  = 16   # user defined chars, UDC_nch
+ROWS = 7    # rows of a glyph, UDC_rows
+COLS = 5    # columns of a glyph
+UDC0 = 128  # char of the first user defined char, utf8Ascii
+
+UDC_SRC  = os.path.join('font', 'hdsp2112_udc.txt')
+MAP_SRC  = os.path.join('font', 'hdsp2112_charset.txt')
+UDC_HDR  = os.path.join('src', 'hdsp2112_udc_font.h')
+MAP_HDR  = os.path.join('src', 'hdsp2112_utf8_map.h')
+
+IDENT = re.compile(r'^[A-Za-z_][A-Za-z0-9_]*$')
+
+
+class GlyphError(Exception):
+    pass
+
+
+def fail(src, line, msg):
+    raise GlyphError('%s:%d: %s' % (src, line, msg))
+
+
+def parse_cp(src, line, tok):
+    m = re.match(r'^U\+([0-9A-Fa-f]{1,6})$', tok)
+    if not m:
+        fail(src, line, 'code point expected (U+xxxx): %s' % tok)
+    cp = int(m.group(1), 16)
+    if (cp < 0x80) or (cp > 0xffff):
+        fail(src, line, 'code point out of range [U+0080..U+FFFF]: %s' % tok)
+    return cp
+
+
+def fnv16(rows):
+    # FNV-1a of the rows, folded to 16 bit
+    h = 0x811c9dc5
+    for r in rows:
+        h = ((h ^ r) * 0x01000193) & 0xffffffff
+    return (h >> 16) ^ (h & 0xffff)
+
+
+def parse_bdf(path, font):
+    # subset of BDF: glyphs up to 5x7 pixels, cell of 7 rows with the
+    # baseline FONT_DESCENT rows above the bottom
+    glyphs = []
+    descent = 0
+    g = None
+    bitmap = None
+    with open(path, encoding='utf-8', errors='replace') as f:
+        for ln, text in enumerate(f, 1):
+            tok = text.split()
+            if not tok:
+                continue
+            key = tok[0]
+            if key == 'FONT_DESCENT':
+                descent = int(tok[1])
+            elif key == 'STARTCHAR':
+                g = {'name': tok[1] if len(tok) > 1 else '-', 'cp': None,
+                     'bbx': (0, 0, 0, 0), 'line': ln}
+            elif (g is not None) and (key == 'ENCODING'):
+                cp = int(tok[1])
+                g['cp'] = cp if 0x80 <= cp <= 0xffff else None
+            elif (g is not None) and (key == 'BBX'):
+                g['bbx'] = tuple(int(t) for t in tok[1:5])
+            elif (g is not None) and (key == 'BITMAP'):
+                bitmap = []
+            elif (g is not None) and (key == 'ENDCHAR'):
+                w, h, xo, yo = g['bbx']
+                rows = [0] * ROWS
+                top = ROWS - descent - (h + yo)
+                for ir, hexrow in enumerate(bitmap or []):
+                    nbits = 4 * len(hexrow)
+                    v = int(hexrow, 16)
+                    for ic in range(w):
+                        if (v >> (nbits - 1 - ic)) & 1:
+                            r, c = top + ir, xo + ic
+                            if not (0 <= r < ROWS and 0 <= c < COLS):
+                                fail(path, g['line'],
+                                     'glyph %s exceeds 5x7' % g['name'])
+                            rows[r] |= 1 << (COLS - 1 - c)
+                name = g['name'] if IDENT.match(g['name']) else '-'
+                glyphs.append({'name': name, 'cp': g['cp'], 'rows': rows,
+                               'font': font, 'src': path, 'line': g['line'],
+                               'comment': []})
+                g = None
+                bitmap = None
+            elif bitmap is not None:
+                bitmap.append(key)
+    return glyphs
+
+
+def parse_udc(path):
+    fonts = []      # (name, first glyph id, number of glyphs)
+    glyphs = []
+    chars = []      # (name, code)
+    comment = []
+    font = None
+    cur = None
+    with open(path, encoding='utf-8') as f:
+        lines = f.read().splitlines()
+    for ln, text in enumerate(lines, 1):
+        s = text.strip()
+        if cur is not None and len(cur['rowtxt']) < ROWS:
+            if not re.match(r'^[#.]{%d}$' % COLS, s):
+                fail(path, ln, 'row of %d pixels expected (# or .)' % COLS)
+            cur['rowtxt'].append(s)
+            if len(cur['rowtxt']) == ROWS:
+                cur['rows'] = [int(r.replace('#', '1').replace('.', '0'), 2)
+                               for r in cur['rowtxt']]
+                cur = None
+            continue
+        if not s:
+            comment = []
+            continue
+        if s.startswith('#'):
+            comment.append(s[1:].strip())
+            continue
+        tok = s.split()
+        if tok[0] == 'font':
+            if len(tok) != 2 or not IDENT.match(tok[1]):
+                fail(path, ln, 'font <name> expected')
+            font = tok[1]
+            fonts.append([font, len(glyphs), 0])
+            comment = []
+        elif tok[0] == 'glyph':
+            if font is None:
+                fail(path, ln, 'glyph outside of a font')
+            if len(tok) not in (2, 3):
+                fail(path, ln, 'glyph <name> [U+xxxx] expected')
+            if tok[1] != '-' and not IDENT.match(tok[1]):
+                fail(path, ln, 'invalid name: %s' % tok[1])
+            cp = parse_cp(path, ln, tok[2]) if len(tok) == 3 else None
+            cur = {'name': tok[1], 'cp': cp, 'rowtxt': [], 'font': font,
+                   'src': path, 'line': ln, 'comment': comment}
+            glyphs.append(cur)
+            fonts[-1][2] += 1
+            comment = []
+        elif tok[0] == 'bdf':
+            if font is None:
+                fail(path, ln, 'bdf outside of a font')
+            bdf = os.path.join(os.path.dirname(path), tok[1])
+            if not os.path.isfile(bdf):
+                fail(path, ln, 'file not found: %s' % bdf)
+            add = parse_bdf(bdf, font)
+            glyphs.extend(add)
+            fonts[-1][2] += len(add)
+            comment = []
+        elif tok[0] == 'char':
+            if len(tok) != 3 or not IDENT.match(tok[1]):
+                fail(path, ln, 'char <name> <code> expected')
+            code = int(tok[2], 0)
+            if not 0 <= code < UDC0 + NCH:
+                fail(path, ln, 'char out of range [0..143]: %s' % tok[2])
+            chars.append((tok[1], code))
+            comment = []
+        else:
+            fail(path, ln, 'unknown keyword: %s' % tok[0])
+    if cur is not None:
+        fail(path, len(lines), 'glyph %s incomplete' % cur['name'])
+    for name, first, n in fonts:
+        if n > NCH:
+            fail(path, 0, 'font %s has %d glyphs (max. %d)' % (name, n, NCH))
+    return fonts, glyphs, chars
+
+
+def parse_map(path):
+    cps = []        # (cp, char, comment)
+    with open(path, encoding='utf-8') as f:
+        for ln, text in enumerate(f, 1):
+            s, _, cmt = text.partition('#')
+            tok = s.split()
+            if not tok:
+                continue
+            if tok[0] != 'map' or len(tok) != 3:
+                fail(path, ln, 'map U+xxxx <code> expected')
+            code = int(tok[2], 0)
+            if not 0 < code < UDC0:
+                fail(path, ln, 'char out of range [1..127]: %s' % tok[2])
+            cps.append((parse_cp(path, ln, tok[1]), code, cmt.strip()))
+    return cps
+
+
+def perfect_hash(cps):
+    # multiplier and table size, which give every code point its own entry
+    # of utf8Hash(cp) = (cp*mul mod 2^32) >> (32-bits)
+    n = max(len(cps), 1)
+    bits = max(1, (n - 1).bit_length())
+    while bits <= 12:
+        for k in range(1, 100000):
+            mul = ((0x9e3779b1 * k) & 0xffffffff) | 1
+            idx = set(((cp * mul) & 0xffffffff) >> (32 - bits) for cp in cps)
+            if len(idx) == len(cps):
+                return mul, bits
+        bits += 1
+    raise GlyphError('no perfect hash found')
+
+
+def fmt_rows(rows):
+    return ', '.join('0b' + format(r, '05b') for r in rows)
+
+
+def gen_udc(fonts, glyphs, chars):
+    out = []
+    out.append('#ifndef __HDSP2112_UDC_FONT_H__')
+    out.append('#define __HDSP2112_UDC_FONT_H__')
+    out.append('')
+    out.append('// user defined characters with 5 columns x 7 rows, generated by')
+    out.append('// tools/udcgen.py from %s, do not edit' % UDC_SRC.replace(os.sep, '/'))
+    out.append('')
+    out.append('#include <hdsp2112.h>')
+    out.append('')
+    out.append('// chars of the named glyphs, valid while their font is loaded')
+    names = set()
+    for name, first, n in fonts:
+        for ig in range(first, first + n):
+            g = glyphs[ig]
+            if g['name'] != '-':
+                if g['name'] in names:
+                    fail(g['src'], g['line'], 'name used twice: %s' % g['name'])
+                names.add(g['name'])
+                out.append('constexpr uint8_t %-10s = %d;   // %s' %
+                           (g['name'], UDC0 + ig - first, name))
+    if chars:
+        out.append('')
+        out.append('// chars of the built-in character set')
+        for name, code in chars:
+            if name in names:
+                raise GlyphError('name used twice: %s' % name)
+            names.add(name)
+            out.append('constexpr uint8_t %-10s = %d;' % (name, code))
+    out.append('')
+    out.append('// font size 5 x 7 (UDC_nch and UDC_rows see hdsp2112.h)')
+    out.append('constexpr uint8_t UDC_size = UDC_nch * UDC_rows; // font-size ')
+    out.append('')
+    out.append('// library of all glyphs, the fonts follow each other, e.g. as glyph')
+    out.append('// library of HdspUdcCache (glyph id = index)')
+    for name, first, n in fonts:
+        cap = name[0].upper() + name[1:]
+        out.append('constexpr uint16_t UDC_id%-6s = %d;%s// first glyph of UDC_%s' %
+                   (cap, first, ' ' * max(1, 8 - len(str(first))), name))
+        out.append('constexpr uint8_t  UDC_n%-7s = %d;%s// glyphs of UDC_%s' %
+                   (cap, n, ' ' * max(1, 8 - len(str(n))), name))
+    out.append('constexpr uint16_t UDC_nLib     = %d;%s// number of glyphs' %
+               (len(glyphs), ' ' * max(1, 8 - len(str(len(glyphs))))))
+    out.append('')
+    out.append('constexpr uint8_t UDC_lib[UDC_nLib * UDC_rows] = {')
+    for name, first, n in fonts:
+        out.append('  // UDC_%s' % name)
+        for ig in range(first, first + n):
+            g = glyphs[ig]
+            for c in g['comment']:
+                out.append('  // %s' % c)
+            cp = (' U+%04X' % g['cp']) if g['cp'] is not None else ''
+            label = '' if g['name'] == '-' else ' ' + g['name']
+            out.append('  %s,   // [%d]%s%s' %
+                       (fmt_rows(g['rows']), UDC0 + ig - first, label, cp))
+    out.append('};')
+    out.append('')
+    out.append('// hash of each glyph (FNV-1a of the rows, folded to 16 bit), glyphs')
+    out.append('// with different hash differ, e.g. for the lookup of HdspUdcCache')
+    out.append('constexpr uint16_t UDC_hash[UDC_nLib] = {')
+    hashes = ['0x%04x' % fnv16(g['rows']) for g in glyphs]
+    for i in range(0, len(hashes), 8):
+        out.append('  ' + ', '.join(hashes[i:i + 8]) + ',')
+    out.append('};')
+    out.append('')
+    out.append('// fonts, e.g. for SetUdcFont(UDC_font,UDC_nch), same rows as UDC_lib')
+    for name, first, n in fonts:
+        cap = name[0].upper() + name[1:]
+        size = 'UDC_size' if n == NCH else 'UDC_n%s * UDC_rows' % cap
+        out.append('const uint8_t UDC_%s[%s] = {' % (name, size))
+        for ig in range(first, first + n):
+            g = glyphs[ig]
+            label = '' if g['name'] == '-' else ' ' + g['name']
+            out.append('  %s,   // [%d]%s' %
+                       (fmt_rows(g['rows']), UDC0 + ig - first, label))
+        out.append('};')
+    checks = [(g, UDC0 + ig - first) for name, first, n in fonts
+              for ig, g in enumerate(glyphs[first:first + n], first)
+              if g['cp'] is not None]
+    if checks:
+        out.append('')
+        out.append('// code points of the glyphs, see hdsp2112_utf8_map.h')
+        for g, ch in checks:
+            what = g['name'] if g['name'] != '-' else str(ch)
+            out.append('static_assert(utf8Glyph(0x%04x)==%s, "utf8 map of %s is outdated");' %
+                       (g['cp'], what, what))
+    out.append('')
+    out.append('#endif ')
+    out.append('//__HDSP2112_UDC_FONT_H__')
+    return '\n'.join(out) + '\n'
+
+
+def gen_map(fonts, glyphs, cps):
+    ent = {}
+    for cp, ch, cmt in cps:
+        if cp in ent:
+            raise GlyphError('U+%04X mapped twice' % cp)
+        ent[cp] = (ch, cmt)
+    for name, first, n in fonts:
+        for ig in range(first, first + n):
+            g = glyphs[ig]
+            if g['cp'] is not None:
+                if g['cp'] in ent:
+                    fail(g['src'], g['line'], 'U+%04X mapped twice' % g['cp'])
+                label = g['name'] if g['name'] != '-' else 'glyph'
+                ent[g['cp']] = (UDC0 + ig - first,
+                                '%s of UDC_%s' % (label, name))
+    mul, bits = perfect_hash(list(ent))
+    tab = [None] * (1 << bits)
+    for cp in ent:
+        tab[((cp * mul) & 0xffffffff) >> (32 - bits)] = cp
+    out = []
+    out.append('#ifndef __HDSP2112_UTF8_MAP_H__')
+    out.append('#define __HDSP2112_UTF8_MAP_H__')
+    out.append('')
+    out.append('// code points above ascii, which can be shown, generated by')
+    out.append('// tools/udcgen.py from %s and' % MAP_SRC.replace(os.sep, '/'))
+    out.append('// %s, do not edit. Perfect hash: each code point' %
+               UDC_SRC.replace(os.sep, '/'))
+    out.append('// has its own entry at utf8Hash(cp), a lookup is a single compare,')
+    out.append('// see utf8Glyph().')
+    out.append('')
+    out.append('constexpr uint32_t utf8HashMul  = 0x%08x;' % mul)
+    out.append('constexpr uint8_t  utf8HashBits = %d;' % bits)
+    out.append('constexpr size_t   utf8nGlyphs  = %d;   // code points in the table' % len(ent))
+    out.append('')
+    out.append('constexpr HdspGlyph utf8Glyphs[1u<<utf8HashBits] = {')
+    for cp in tab:
+        if cp is None:
+            out.append('  { 0x0000, 0x00 },')
+        else:
+            ch, cmt = ent[cp]
+            out.append('  { 0x%04x, %-4s },   // %s' %
+                       (cp, ('0x%02x' % ch) if ch < UDC0 else str(ch), cmt))
+    out.append('};')
+    out.append('')
+    out.append('#endif')
+    out.append('//__HDSP2112_UTF8_MAP_H__')
+    return '\n'.join(out) + '\n'
+
+
+def update(path, text):
+    # writes the header only if it changes, i.e. no needless rebuilds
+    old = None
+    if os.path.isfile(path):
+        with open(path, encoding='utf-8') as f:
+            old = f.read()
+    if old != text:
+        with open(path, 'w', encoding='utf-8', newline='\n') as f:
+            f.write(text)
+        print('udcgen: %s updated' % path)
+
+
+def main(root):
+    fonts, glyphs, chars = parse_udc(os.path.join(root, UDC_SRC))
+    cps = parse_map(os.path.join(root, MAP_SRC))
+    for g in glyphs:
+        g['src'] = os.path.relpath(g['src'], root)
+    update(os.path.join(root, MAP_HDR), gen_map(fonts, glyphs, cps))
+    update(os.path.join(root, UDC_HDR), gen_udc(fonts, glyphs, chars))
+
+
+try:
+    Import('env')                                  # run by PlatformIO
+    ROOT = env.subst('$PROJECT_DIR')               # noqa: F821
+except NameError:
+    ROOT = sys.argv[1] if len(sys.argv) > 1 else \
+        os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+try:
+    main(ROOT)
+except GlyphError as e:
+    sys.stderr.write('udcgen: %s\n' % e)
+    sys.exit(1)